@@ -0,0 +1,59 @@
+# Compares keff between a double precision build of Scarabee and a build with
+# the SCARABEE_MIXED_PRECISION CMake option, on the C5G7 benchmark and a BEAVRS
+# assembly. Run this script from the examples directory once with each build.
+# The double precision build writes the reference keffs to REFERENCE, and the
+# mixed precision build compares against them. The BEAVRS assembly needs the
+# nuclear data library used by the beavrs examples.
+import json
+import os
+import runpy
+import sys
+
+os.environ.setdefault("MPLBACKEND", "Agg")
+
+import scarabee
+
+REFERENCE = "mixed_precision_keff.json"
+MAX_DIFF_PCM = 1.0
+
+# Script of each case, and the name of the MOCDriver in its globals
+CASES = {
+    "c5g7": ("c5g7.py", lambda g: g["moc"]),
+    "beavrs_31_0": ("beavrs/assembly_31_0.py", lambda g: g["asmbly"].moc),
+}
+
+
+def run_case(script, get_moc):
+    # The examples converge keff to 1 pcm, so the final MOC problem is solved
+    # again with tighter tolerances before the builds are compared
+    cwd = os.getcwd()
+    os.chdir(os.path.dirname(os.path.abspath(script)))
+    try:
+        moc = get_moc(runpy.run_path(os.path.basename(script)))
+        moc.keff_tolerance = 1.0e-8
+        moc.flux_tolerance = 1.0e-7
+        moc.solve()
+    finally:
+        os.chdir(cwd)
+    return moc.keff
+
+
+keffs = {name: run_case(*case) for name, case in CASES.items()}
+
+if not scarabee.MOC_MIXED_PRECISION:
+    with open(REFERENCE, "w") as f:
+        json.dump(keffs, f, indent=2)
+    print("Wrote the double precision keffs to {}".format(REFERENCE))
+    sys.exit(0)
+
+with open(REFERENCE) as f:
+    reference = json.load(f)
+
+failed = False
+for name, keff in keffs.items():
+    diff = 1.0e5 * (keff - reference[name])
+    print("{:12s} double: {:.6f}  mixed: {:.6f}  diff: {:+.3f} pcm".format(
+        name, reference[name], keff, diff))
+    failed = failed or abs(diff) > MAX_DIFF_PCM
+
+sys.exit(1 if failed else 0)
@@ -2,6 +2,7 @@
 #include <utils/scarabee_exception.hpp>
 #include <utils/logging.hpp>
 #include <utils/constants.hpp>
+#include <utils/hash.hpp>
 
 #include <algorithm>
 #include <optional>
@@ -202,6 +203,35 @@ void Cartesian2D::set_tiles(const std::vector<TileFill>& fills) {
   make_offset_map();
 }
 
+std::optional<std::size_t> Cartesian2D::find_bound_interval(
+    const std::vector<std::shared_ptr<Surface>>& bounds, double coord,
+    bool x_axis, const Vector& r, const Direction& u) {
+  // The bounds are sorted, so a binary search gives the candidate interval.
+  // When r lies on a bound, the side of the surface is decided by the
+  // direction u, so the true interval may be a neighbor of the candidate.
+  // These are therefore also checked with Surface::side.
+  auto it = std::upper_bound(
+      bounds.begin(), bounds.end(), coord,
+      [x_axis](double c, const std::shared_ptr<Surface>& s) {
+        return c < (x_axis ? s->x0() : s->y0());
+      });
+
+  const std::size_t n = bounds.size() - 1;  // Number of intervals
+  std::size_t ic = static_cast<std::size_t>(it - bounds.begin());
+  ic = ic > 0 ? ic - 1 : 0;
+  const std::size_t i_low = ic > 0 ? ic - 1 : 0;
+  const std::size_t i_hi = std::min(ic + 1, n - 1);
+
+  for (std::size_t i = i_low; i <= i_hi; i++) {
+    if (bounds[i]->side(r, u) == Surface::Side::Positive &&
+        bounds[i + 1]->side(r, u) == Surface::Side::Negative) {
+      return i;
+    }
+  }
+
+  return std::nullopt;
+}
+
 std::pair<double, double> Cartesian2D::tile_dx_dy(const TileIndex& ti) const {
   // Get the lower and upper x and y bounds
   const double xl = x_bounds_[ti.i]->x0();
@@ -212,6 +242,23 @@ std::pair<double, double> Cartesian2D::tile_dx_dy(const TileIndex& ti) const {
   return {xh - xl, yh - yl};
 }
 
+std::optional<std::pair<double, double>> Cartesian2D::uniform_tile_size()
+    const {
+  const auto dxdy = tile_dx_dy({0, 0});
+
+  for (std::size_t i = 1; i < nx_; i++) {
+    if (std::abs(tile_dx_dy({i, 0}).first - dxdy.first) > VEC_FP_TOL)
+      return std::nullopt;
+  }
+
+  for (std::size_t j = 1; j < ny_; j++) {
+    if (std::abs(tile_dx_dy({0, j}).second - dxdy.second) > VEC_FP_TOL)
+      return std::nullopt;
+  }
+
+  return dxdy;
+}
+
 bool Cartesian2D::tiles_valid() const {
   for (const auto& t : tiles_) {
     if (t.valid() == false) return false;
@@ -391,6 +438,62 @@ void Cartesian2D::fill_fsrs(
   }
 }
 
+std::vector<double> Cartesian2D::geometry_layout() const {
+  // FSR ids are stored relative to the smallest id, so that two geometries
+  // built in the same manner have the same layout.
+  const auto fsr_ids = this->get_all_fsr_ids();
+  const std::size_t min_id = fsr_ids.empty() ? 0 : *fsr_ids.begin();
+
+  std::vector<double> layout;
+  this->append_layout(layout, min_id);
+  return layout;
+}
+
+std::size_t Cartesian2D::geometry_hash() const {
+  std::size_t seed = 0;
+  for (const double v : this->geometry_layout()) hash_combine(seed, v);
+  return seed;
+}
+
+inline void append_cell_layout(std::vector<double>& layout, const Cell& cell,
+                               std::size_t min_id) {
+  layout.push_back(cell.dx());
+  layout.push_back(cell.dy());
+
+  std::map<std::size_t, const FlatSourceRegion*> fsrs;
+  cell.fill_fsrs(fsrs);
+  for (const auto& [id, fsr] : fsrs) {
+    layout.push_back(static_cast<double>(id - min_id));
+    layout.push_back(fsr->volume());
+    for (const auto& token : fsr->tokens()) {
+      const auto& surf = *token.surface;
+      layout.push_back(static_cast<double>(surf.type()));
+      layout.push_back(surf.x0());
+      layout.push_back(surf.y0());
+      layout.push_back(surf.r());
+      layout.push_back(token.side == Surface::Side::Positive ? 1. : 0.);
+    }
+  }
+}
+
+void Cartesian2D::append_layout(std::vector<double>& layout,
+                                std::size_t min_id) const {
+  layout.push_back(static_cast<double>(nx_));
+  layout.push_back(static_cast<double>(ny_));
+  for (const auto& xb : x_bounds_) layout.push_back(xb->x0());
+  for (const auto& yb : y_bounds_) layout.push_back(yb->y0());
+
+  for (const auto& t : tiles_) {
+    if (t.c2d) {
+      layout.push_back(1.);
+      t.c2d->append_layout(layout, min_id);
+    } else if (t.cell) {
+      layout.push_back(2.);
+      append_cell_layout(layout, *t.cell, min_id);
+    }
+  }
+}
+
 void Cartesian2D::make_offset_map() {
   auto fsr_ids = this->get_all_fsr_ids();
 
@@ -2,6 +2,8 @@
 #include <utils/scarabee_exception.hpp>
 #include <utils/logging.hpp>
 
+#include <algorithm>
+#include <cmath>
 #include <sstream>
 
 namespace scarabee {
@@ -77,6 +79,114 @@ void Cell::check_surfaces() const {
   }
 }
 
+// Octant of the direction (x, y) around the origin, counted counter-clockwise
+// from the positive x axis
+inline std::size_t octant(double x, double y) {
+  if (y >= 0.) {
+    if (x > 0.) return y < x ? 0 : 1;
+    return y > -x ? 2 : 3;
+  }
+  if (x < 0.) return y > x ? 4 : 5;
+  return -y > x ? 6 : 7;
+}
+
+void Cell::build_fsr_lookup() {
+  lookup_radii2_.clear();
+  ring_fsrs_.clear();
+  sector_fsrs_.clear();
+
+  // All cylinders must share the same center
+  bool found_cylinder = false;
+  std::vector<double> radii;
+  for (const auto& fsr : fsrs_) {
+    for (const auto& t : fsr.tokens()) {
+      if (t.surface->type() != Surface::Type::Cylinder) continue;
+      if (found_cylinder == false) {
+        lookup_x0_ = t.surface->x0();
+        lookup_y0_ = t.surface->y0();
+        found_cylinder = true;
+      } else if (t.surface->x0() != lookup_x0_ ||
+                 t.surface->y0() != lookup_y0_) {
+        return;
+      }
+      radii.push_back(t.surface->r());
+    }
+  }
+  if (found_cylinder == false) return;
+
+  std::sort(radii.begin(), radii.end());
+  radii.erase(std::unique(radii.begin(), radii.end()), radii.end());
+
+  // An FSR lies in the ring of the smallest cylinder it is inside of, or in
+  // the last ring when it is outside of all cylinders
+  const std::size_t nrings = radii.size() + 1;
+  ring_fsrs_.resize(nrings);
+  for (std::size_t f = 0; f < fsrs_.size(); f++) {
+    std::size_t ring = radii.size();
+    for (const auto& t : fsrs_[f].tokens()) {
+      if (t.surface->type() != Surface::Type::Cylinder ||
+          t.side != Surface::Side::Negative) {
+        continue;
+      }
+      const auto it =
+          std::lower_bound(radii.begin(), radii.end(), t.surface->r());
+      ring = std::min(ring, static_cast<std::size_t>(it - radii.begin()));
+    }
+    ring_fsrs_[ring].push_back(f);
+  }
+
+  // The FSR of each ring and octant is found at the middle of the sector.
+  // The last ring is probed halfway to the closest cell wall, or just
+  // outside of the largest radius when the wall is closer.
+  const double half_width =
+      0.5 * std::min(x_max_->x0() - x_min_->x0(), y_max_->y0() - y_min_->y0());
+  const Direction u(1., 0.);
+  sector_fsrs_.assign(nrings * NUM_OCTANTS, NO_FSR);
+  for (std::size_t k = 0; k < nrings; k++) {
+    const double r_in = k > 0 ? radii[k - 1] : 0.;
+    const double r_out =
+        k < radii.size() ? radii[k] : std::max(half_width, 1.01 * r_in);
+    const double r_mid = 0.5 * (r_in + r_out);
+    for (std::size_t o = 0; o < NUM_OCTANTS; o++) {
+      const double phi = (static_cast<double>(o) + 0.5) * 0.25 * PI;
+      const Vector p(lookup_x0_ + r_mid * std::cos(phi),
+                     lookup_y0_ + r_mid * std::sin(phi));
+      for (const auto f : ring_fsrs_[k]) {
+        if (fsrs_[f].inside(p, u)) {
+          sector_fsrs_[k * NUM_OCTANTS + o] = f;
+          break;
+        }
+      }
+    }
+  }
+
+  lookup_radii2_.reserve(radii.size());
+  for (const auto rad : radii) lookup_radii2_.push_back(rad * rad);
+}
+
+const FlatSourceRegion* Cell::lookup_fsr(const Vector& r,
+                                         const Direction& u) const {
+  if (ring_fsrs_.empty()) return nullptr;
+
+  const double x = r.x() - lookup_x0_;
+  const double y = r.y() - lookup_y0_;
+  const double d2 = x * x + y * y;
+  const std::size_t k = static_cast<std::size_t>(
+      std::upper_bound(lookup_radii2_.begin(), lookup_radii2_.end(), d2) -
+      lookup_radii2_.begin());
+
+  const std::size_t guess = sector_fsrs_[k * NUM_OCTANTS + octant(x, y)];
+  if (guess != NO_FSR && fsrs_[guess].inside(r, u)) return &fsrs_[guess];
+
+  // Points on a sector boundary, or in an FSR which is not a simple sector
+  for (const auto f : ring_fsrs_[k]) {
+    if (f != guess && fsrs_[f].inside(r, u)) return &fsrs_[f];
+  }
+
+  // Points on a ring boundary fall back to the linear search
+  return nullptr;
+}
+
 std::vector<UniqueFSR> Cell::get_all_fsr_in_cell(const Vector& /*r*/,
                                                  const Direction& /*u*/) const {
   std::vector<UniqueFSR> out;
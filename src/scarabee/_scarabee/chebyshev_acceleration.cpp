@@ -0,0 +1,66 @@
+#include <utils/chebyshev_acceleration.hpp>
+
+#include <cmath>
+
+namespace scarabee {
+
+ChebyshevAcceleration::ChebyshevAcceleration(std::size_t free_iterations,
+                                             std::size_t cycle_length)
+    : free_iterations_(free_iterations), cycle_length_(cycle_length) {}
+
+void ChebyshevAcceleration::reset() {
+  x_prev_.clear();
+  n_free_ = 0;
+  p_ = 0;
+  prev_res_ = 0.;
+  cycle_res_ = 0.;
+  rho_ = 0.;
+  gamma_ = 0.;
+}
+
+bool ChebyshevAcceleration::begin_step(double res) {
+  if (p_ > 0 && res > cycle_res_) {
+    // The extrapolation is diverging, so start over with free iterations
+    p_ = 0;
+    n_free_ = 0;
+    prev_res_ = 0.;
+  }
+
+  if (p_ == 0) {
+    // Free iteration, used to estimate the dominance ratio
+    if (prev_res_ > 0.) rho_ = res / prev_res_;
+    prev_res_ = res;
+    n_free_++;
+
+    if (n_free_ >= free_iterations_ && rho_ > MIN_DOMINANCE_RATIO &&
+        rho_ < 1.) {
+      p_ = 1;
+      cycle_res_ = res;
+      gamma_ = std::acosh(2. / rho_ - 1.);
+    }
+
+    return false;
+  }
+
+  a_ = 2. / (2. - rho_);
+  b_ = 0.;
+  if (p_ > 1) {
+    const double dp = static_cast<double>(p_);
+    a_ = (4. / rho_) * std::cosh((dp - 1.) * gamma_) / std::cosh(dp * gamma_);
+    b_ = (1. - 0.5 * rho_) * a_ - 1.;
+  }
+
+  return true;
+}
+
+void ChebyshevAcceleration::end_step() {
+  p_++;
+  if (p_ > cycle_length_) {
+    // End of the cycle. The dominance ratio is estimated again.
+    p_ = 0;
+    n_free_ = 0;
+    prev_res_ = 0.;
+  }
+}
+
+}  // namespace scarabee
@@ -4,10 +4,22 @@
 #include <utils/scarabee_exception.hpp>
 #include <utils/constants.hpp>
 
+#include <xtensor/xview.hpp>
+
+#include <algorithm>
 #include <cmath>
+#include <limits>
+#include <sstream>
+#include <vector>
 
 namespace scarabee {
 
+// Maximum number of power iterations for the coarse problem
+constexpr std::size_t MAX_ITERATIONS{1000};
+
+// Relative residual of the linear solves of the coarse problem
+constexpr double LINEAR_TOLERANCE{1.E-10};
+
 CMFD::CMFD(const std::vector<double>& dx, const std::vector<double>& dy,
            const std::vector<std::pair<std::size_t, std::size_t>>& groups)
     : dx_(dx),
@@ -130,18 +142,99 @@ CMFD::CMFD(const std::vector<double>& dx, const std::vector<double>& dy,
   surface_currents_ =
       xt::zeros<double>({group_condensation_.size(), nx_surfs_ + ny_surfs_});
 
-  // Allocate the xs array
-  xs_.resize({nx_, ny_});
-  xs_.fill(nullptr);
-
   // Allocate the flux array
   flux_ = xt::zeros<double>({ng_, nx_, ny_});
+
+  this->allocate_work_arrays();
+}
+
+void CMFD::allocate_work_arrays() {
+  const std::size_t NG = moc_to_cmfd_group_map_.size();
+  const std::size_t NC = nx_ * ny_;
+  const std::size_t N = ng_ * NC;
+  const Eigen::Index n = static_cast<Eigen::Index>(N);
+
+  D_.resize({ng_, nx_, ny_});
+  Er_.resize({ng_, nx_, ny_});
+  vEf_.resize({ng_, nx_, ny_});
+  chi_.resize({ng_, nx_, ny_});
+  Es_.resize({ng_, ng_, nx_, ny_});
+  fine_flux_.resize({NG});
+  fine_Etr_.resize({NG});
+  fine_chi_.resize({NG});
+  cmfd_flux_.resize({ng_, nx_, ny_});
+  ratios_.resize({ng_, NC});
+
+  for (auto* vec : {&cflux_, &new_cflux_, &Q_, &V_, &VvEf_, &invs_diag_, &r_,
+                    &r0_, &p_, &v_, &s_, &t_, &y_, &z_}) {
+    vec->resize(n);
+  }
+
+  // The loss matrix couples each tile to its neighbors in the same group, and
+  // to itself in all other groups. The fission matrix couples each tile to
+  // itself in all groups.
+  auto indx = [NC](std::size_t G, std::size_t c) {
+    return static_cast<Eigen::Index>(G * NC + c);
+  };
+  std::vector<Eigen::Triplet<double, Eigen::Index>> M_entries;
+  std::vector<Eigen::Triplet<double, Eigen::Index>> F_entries;
+  M_entries.reserve(N * (4 + ng_));
+  F_entries.reserve(N * ng_);
+  for (std::size_t G = 0; G < ng_; G++) {
+    for (std::size_t i = 0; i < nx_; i++) {
+      for (std::size_t j = 0; j < ny_; j++) {
+        const Eigen::Index row = indx(G, this->tile_to_indx(i, j));
+        if (i > 0)
+          M_entries.emplace_back(row, indx(G, this->tile_to_indx(i - 1, j)));
+        if (i + 1 < nx_)
+          M_entries.emplace_back(row, indx(G, this->tile_to_indx(i + 1, j)));
+        if (j > 0)
+          M_entries.emplace_back(row, indx(G, this->tile_to_indx(i, j - 1)));
+        if (j + 1 < ny_)
+          M_entries.emplace_back(row, indx(G, this->tile_to_indx(i, j + 1)));
+
+        for (std::size_t GG = 0; GG < ng_; GG++) {
+          const Eigen::Index col = indx(GG, this->tile_to_indx(i, j));
+          M_entries.emplace_back(row, col);
+          F_entries.emplace_back(row, col);
+        }
+      }
+    }
+  }
+
+  M_.resize(n, n);
+  M_.setFromTriplets(M_entries.begin(), M_entries.end());
+  M_.makeCompressed();
+  F_.resize(n, n);
+  F_.setFromTriplets(F_entries.begin(), F_entries.end());
+  F_.makeCompressed();
 }
 
 std::optional<std::array<std::size_t, 2>> CMFD::get_tile(
     const Vector& r, const Direction& u) const {
-  for (std::size_t i = 0; i < nx(); i++) {
-    for (std::size_t j = 0; j < ny(); j++) {
+  // The bounds are sorted, so we can use a binary search to find the
+  // candidate bin in each direction. Because of the direction-dependent
+  // tie-breaking when on a surface, the true tile might be a neighbor of the
+  // candidate, so we check those as well.
+  auto xit = std::upper_bound(
+      x_bounds_.begin(), x_bounds_.end(), r.x(),
+      [](double x, const Surface& s) { return x < s.x0(); });
+  auto yit = std::upper_bound(
+      y_bounds_.begin(), y_bounds_.end(), r.y(),
+      [](double y, const Surface& s) { return y < s.y0(); });
+
+  std::size_t ic = static_cast<std::size_t>(xit - x_bounds_.begin());
+  std::size_t jc = static_cast<std::size_t>(yit - y_bounds_.begin());
+  ic = ic > 0 ? ic - 1 : 0;
+  jc = jc > 0 ? jc - 1 : 0;
+
+  const std::size_t i_low = ic > 0 ? ic - 1 : 0;
+  const std::size_t i_hi = std::min(ic + 1, nx_ - 1);
+  const std::size_t j_low = jc > 0 ? jc - 1 : 0;
+  const std::size_t j_hi = std::min(jc + 1, ny_ - 1);
+
+  for (std::size_t i = i_low; i <= i_hi; i++) {
+    for (std::size_t j = j_low; j <= j_hi; j++) {
       // Get the surfaces that make up our tile
       const auto& xl = x_bounds_[i];
       const auto& xh = x_bounds_[i + 1];
@@ -212,16 +305,62 @@ void CMFD::insert_fsr(const std::array<std::size_t, 2>& tile, std::size_t fsr) {
   temp_fsrs_.at(i).insert(fsr);
 }
 
+void CMFD::reset_fsr_lists() {
+  temp_fsrs_.clear();
+  temp_fsrs_.resize(nx_ * ny_);
+  fsrs_.clear();
+  fsr_tiles_.clear();
+}
+
 void CMFD::pack_fsr_lists() {
   fsrs_.resize(nx_ * ny_, std::vector<std::size_t>());
 
+  std::size_t max_fsr = 0;
   for (std::size_t i = 0; i < fsrs_.size(); i++) {
+    if (temp_fsrs_[i].empty()) {
+      std::stringstream mssg;
+      mssg << "CMFD tile " << i << " does not contain any flat source regions.";
+      spdlog::error(mssg.str());
+      throw ScarabeeException(mssg.str());
+    }
+
     fsrs_[i].insert(fsrs_[i].begin(), temp_fsrs_[i].begin(),
                     temp_fsrs_[i].end());
+
+    max_fsr = std::max(max_fsr, fsrs_[i].back());
   }
 
   temp_fsrs_.clear();
   temp_fsrs_.shrink_to_fit();
+
+  // Build the map from FSR to tile. Each FSR may only belong to a single tile,
+  // otherwise the prolongation of the coarse flux would be ill defined.
+  fsr_tiles_.assign(max_fsr + 1, nx_ * ny_);
+  for (std::size_t t = 0; t < fsrs_.size(); t++) {
+    for (const auto fsr : fsrs_[t]) {
+      if (fsr_tiles_[fsr] != nx_ * ny_) {
+        std::stringstream mssg;
+        mssg << "Flat source region " << fsr
+             << " is located in more than one CMFD tile. The CMFD mesh must "
+                "align with the boundaries of the flat source regions.";
+        spdlog::error(mssg.str());
+        throw ScarabeeException(mssg.str());
+      }
+
+      fsr_tiles_[fsr] = t;
+    }
+  }
+}
+
+const std::vector<std::size_t>& CMFD::fsrs(const std::size_t i,
+                                           const std::size_t j) const {
+  if (i >= nx_ || j >= ny_) {
+    auto mssg = "Tile index out of range.";
+    spdlog::error(mssg);
+    throw ScarabeeException(mssg);
+  }
+
+  return fsrs_.at(this->tile_to_indx(i, j));
 }
 
 std::size_t CMFD::moc_to_cmfd_group(std::size_t g) const {
@@ -290,7 +429,34 @@ void CMFD::tally_current(double aflx, const Direction& u, std::size_t G,
   }
 }
 
+void CMFD::set_flux_tolerance(double ftol) {
+  if (ftol <= 0. || ftol >= 0.1) {
+    auto mssg = "Tolerance for flux must be in the interval (0., 0.1).";
+    spdlog::error(mssg);
+    throw ScarabeeException(mssg);
+  }
+
+  flux_tol_ = ftol;
+}
+
+void CMFD::set_keff_tolerance(double ktol) {
+  if (ktol <= 0. || ktol >= 0.1) {
+    auto mssg = "Tolerance for keff must be in the interval (0., 0.1).";
+    spdlog::error(mssg);
+    throw ScarabeeException(mssg);
+  }
+
+  keff_tol_ = ktol;
+}
+
+void CMFD::zero_currents() {
+  surface_currents_.fill(0.);
+  surface_currents_normalized_ = false;
+}
+
 void CMFD::normalize_currents() {
+  if (surface_currents_normalized_) return;
+
   // We must normalize the currents by the lengths of each surface
 
   // First, go through all y-levels, and normalize the x surfaces
@@ -322,29 +488,438 @@ void CMFD::normalize_currents() {
 }
 
 void CMFD::compute_homogenized_xs_and_flux(const MOCDriver& moc) {
+  // The cross sections of the FSRs in each tile are flux-volume weighted into
+  // the coarse groups in a single pass. This gives the same values as
+  // condensing the cross sections returned by MOCDriver::homogenize, without
+  // building any intermediate cross section objects.
+  const std::size_t NG = moc_to_cmfd_group_map_.size();
+
   for (std::size_t i = 0; i < nx_; i++) {
     for (std::size_t j = 0; j < ny_; j++) {
       const auto indx = this->tile_to_indx(i, j);
-      const auto fg_xs = moc.homogenize(fsrs_[indx])->diffusion_xs();
-      const auto flux_spec = moc.homogenize_flux_spectrum(fsrs_[indx]);
-      auto& xs = xs_(i, j);
-      if (xs)
-        *xs = *fg_xs->condense(group_condensation_, flux_spec);
-      else
-        xs = fg_xs->condense(group_condensation_, flux_spec);
-
-      // Generate the flux values for the tile
-      xt::view(flux_, xt::all(), i, j) = 0.;
-      for (std::size_t g = 0; g < moc_to_cmfd_group_map_.size(); g++) {
-        flux_(moc_to_cmfd_group_map_[g], i, j) += flux_spec(g);
+
+      fine_flux_.fill(0.);
+      fine_Etr_.fill(0.);
+      fine_chi_.fill(0.);
+      xt::view(Er_, xt::all(), i, j) = 0.;
+      xt::view(vEf_, xt::all(), i, j) = 0.;
+      xt::view(Es_, xt::all(), xt::all(), i, j) = 0.;
+      double V_tile = 0.;
+      double fiss_prod = 0.;
+
+      for (const auto fsr : fsrs_[indx]) {
+        const auto& mat = *moc.xs(fsr);
+        const double V = moc.volume(fsr);
+        V_tile += V;
+
+        double fsr_fiss_prod = 0.;
+        for (std::size_t g = 0; g < NG; g++) {
+          const std::size_t G = moc_to_cmfd_group_map_[g];
+          const double flxV = moc.flux(fsr, g) * V;
+          fine_flux_(g) += flxV;
+          fine_Etr_(g) += flxV * (mat.Ea(g) + mat.Es_tr(g));
+          Er_(G, i, j) += flxV * mat.Ea(g);
+          vEf_(G, i, j) += flxV * mat.vEf(g);
+          for (std::size_t gg = 0; gg < NG; gg++) {
+            Es_(G, moc_to_cmfd_group_map_[gg], i, j) +=
+                flxV * mat.Es_tr(g, gg);
+          }
+          fsr_fiss_prod += flxV * mat.vEf(g);
+        }
+
+        for (std::size_t g = 0; g < NG; g++) {
+          fine_chi_(g) += fsr_fiss_prod * mat.chi(g);
+        }
+        fiss_prod += fsr_fiss_prod;
+      }
+
+      const double invs_fiss_prod = fiss_prod > 0. ? 1. / fiss_prod : 1.;
+      for (std::size_t G = 0; G < ng_; G++) {
+        const std::size_t g_min = group_condensation_[G].first;
+        const std::size_t g_max = group_condensation_[G].second;
+
+        double flxV_G = 0.;
+        for (std::size_t g = g_min; g <= g_max; g++) flxV_G += fine_flux_(g);
+        const double invs_flxV_G = 1. / flxV_G;
+
+        // The diffusion coefficient of each fine group is 1 / (3 Etr)
+        D_(G, i, j) = 0.;
+        chi_(G, i, j) = 0.;
+        for (std::size_t g = g_min; g <= g_max; g++) {
+          const double Etr_g = fine_Etr_(g) / fine_flux_(g);
+          D_(G, i, j) += fine_flux_(g) * invs_flxV_G / (3. * Etr_g);
+          chi_(G, i, j) += invs_fiss_prod * fine_chi_(g);
+        }
+
+        Er_(G, i, j) *= invs_flxV_G;
+        vEf_(G, i, j) *= invs_flxV_G;
+        for (std::size_t GG = 0; GG < ng_; GG++) {
+          Es_(G, GG, i, j) *= invs_flxV_G;
+        }
+
+        // Removal is absorption and out-scattering
+        for (std::size_t GG = 0; GG < ng_; GG++) {
+          if (GG != G) Er_(G, i, j) += Es_(G, GG, i, j);
+        }
+
+        // Volume averaged flux of the tile
+        flux_(G, i, j) = flxV_G / V_tile;
       }
     }
   }
 }
 
+void CMFD::calc_surface_coefficients(std::size_t G, std::size_t surf,
+                                     const std::optional<std::size_t>& neg,
+                                     const std::optional<std::size_t>& pos,
+                                     double h_neg, double h_pos, double& Dt,
+                                     double& Dh) const {
+  // Net current across the surface, in the positive x or y direction
+  const double J = surface_currents_(G, surf);
+  Dt = 0.;
+  Dh = 0.;
+
+  if (neg && pos) {
+    const std::size_t in = *neg % nx_;
+    const std::size_t jn = *neg / nx_;
+    const std::size_t ip = *pos % nx_;
+    const std::size_t jp = *pos / nx_;
+    const double D_n = D_(G, in, jn);
+    const double D_p = D_(G, ip, jp);
+    const double flx_n = flux_(G, in, jn);
+    const double flx_p = flux_(G, ip, jp);
+
+    // Standard finite difference coupling coefficient
+    Dt = 2. * D_n * D_p / (h_neg * D_p + h_pos * D_n);
+
+    // Non-linear correction, which makes the coarse current agree with MOC
+    Dh = (-J - Dt * (flx_p - flx_n)) / (flx_p + flx_n);
+
+    // If the correction is larger than the coupling coefficient, the coarse
+    // operator may no longer be positive. In that case, we redefine the
+    // coefficients so that the current only depends on the upwind flux.
+    if (std::abs(Dh) > Dt) {
+      if (J > 0.) {
+        Dt = J / (2. * flx_n);
+        Dh = -Dt;
+      } else {
+        Dt = -J / (2. * flx_p);
+        Dh = Dt;
+      }
+    }
+  } else if (neg) {
+    // Surface on the positive boundary of the problem. The outgoing current
+    // is given directly by MOC, so only a non-linear term is used.
+    const std::size_t in = *neg % nx_;
+    const std::size_t jn = *neg / nx_;
+    Dh = J / flux_(G, in, jn);
+  } else if (pos) {
+    // Surface on the negative boundary of the problem
+    const std::size_t ip = *pos % nx_;
+    const std::size_t jp = *pos / nx_;
+    Dh = -J / flux_(G, ip, jp);
+  }
+}
+
 void CMFD::solve(MOCDriver& moc) {
   this->normalize_currents();
   this->compute_homogenized_xs_and_flux(moc);
+
+  // The coarse flux must be positive to compute the coupling coefficients
+  for (const auto& flx : flux_) {
+    if (flx <= 0. || std::isfinite(flx) == false) {
+      spdlog::warn("Non-positive CMFD flux. Skipping CMFD acceleration.");
+      return;
+    }
+  }
+
+  const std::size_t NC = nx_ * ny_;
+
+  // Fill the loss and fission matrices. All entries are already in their
+  // sparsity pattern.
+  auto& M = M_;
+  auto& F = F_;
+  M.coeffs().setZero();
+  F.coeffs().setZero();
+
+  auto indx = [NC](std::size_t G, std::size_t c) {
+    return static_cast<Eigen::Index>(G * NC + c);
+  };
+
+  for (std::size_t G = 0; G < ng_; G++) {
+    double Dt, Dh;
+
+    // Surfaces normal to the x axis
+    for (std::size_t j = 0; j < ny_; j++) {
+      for (std::size_t k = 0; k < x_bounds_.size(); k++) {
+        const std::size_t surf = j * x_bounds_.size() + k;
+        std::optional<std::size_t> neg, pos;
+        double h_neg = 0., h_pos = 0.;
+        if (k > 0) {
+          neg = this->tile_to_indx(k - 1, j);
+          h_neg = dx_[k - 1];
+        }
+        if (k < nx_) {
+          pos = this->tile_to_indx(k, j);
+          h_pos = dx_[k];
+        }
+
+        this->calc_surface_coefficients(G, surf, neg, pos, h_neg, h_pos, Dt,
+                                        Dh);
+
+        // Current in the positive direction is
+        // J = (Dt - Dh)*flux_neg - (Dt + Dh)*flux_pos
+        if (neg && pos) {
+          M.coeffRef(indx(G, *neg), indx(G, *neg)) += (Dt - Dh) / h_neg;
+          M.coeffRef(indx(G, *neg), indx(G, *pos)) -= (Dt + Dh) / h_neg;
+          M.coeffRef(indx(G, *pos), indx(G, *pos)) += (Dt + Dh) / h_pos;
+          M.coeffRef(indx(G, *pos), indx(G, *neg)) -= (Dt - Dh) / h_pos;
+        } else if (neg) {
+          M.coeffRef(indx(G, *neg), indx(G, *neg)) += Dh / h_neg;
+        } else if (pos) {
+          M.coeffRef(indx(G, *pos), indx(G, *pos)) += Dh / h_pos;
+        }
+      }
+    }
+
+    // Surfaces normal to the y axis
+    for (std::size_t i = 0; i < nx_; i++) {
+      for (std::size_t k = 0; k < y_bounds_.size(); k++) {
+        const std::size_t surf = nx_surfs_ + i * y_bounds_.size() + k;
+        std::optional<std::size_t> neg, pos;
+        double h_neg = 0., h_pos = 0.;
+        if (k > 0) {
+          neg = this->tile_to_indx(i, k - 1);
+          h_neg = dy_[k - 1];
+        }
+        if (k < ny_) {
+          pos = this->tile_to_indx(i, k);
+          h_pos = dy_[k];
+        }
+
+        this->calc_surface_coefficients(G, surf, neg, pos, h_neg, h_pos, Dt,
+                                        Dh);
+
+        if (neg && pos) {
+          M.coeffRef(indx(G, *neg), indx(G, *neg)) += (Dt - Dh) / h_neg;
+          M.coeffRef(indx(G, *neg), indx(G, *pos)) -= (Dt + Dh) / h_neg;
+          M.coeffRef(indx(G, *pos), indx(G, *pos)) += (Dt + Dh) / h_pos;
+          M.coeffRef(indx(G, *pos), indx(G, *neg)) -= (Dt - Dh) / h_pos;
+        } else if (neg) {
+          M.coeffRef(indx(G, *neg), indx(G, *neg)) += Dh / h_neg;
+        } else if (pos) {
+          M.coeffRef(indx(G, *pos), indx(G, *pos)) += Dh / h_pos;
+        }
+      }
+    }
+
+    // Removal, in-scattering, and fission
+    for (std::size_t i = 0; i < nx_; i++) {
+      for (std::size_t j = 0; j < ny_; j++) {
+        const std::size_t c = this->tile_to_indx(i, j);
+        M.coeffRef(indx(G, c), indx(G, c)) += Er_(G, i, j);
+
+        for (std::size_t GG = 0; GG < ng_; GG++) {
+          if (GG != G)
+            M.coeffRef(indx(G, c), indx(GG, c)) -= Es_(GG, G, i, j);
+
+          F.coeffRef(indx(G, c), indx(GG, c)) = chi_(G, i, j) * vEf_(GG, i, j);
+        }
+      }
+    }
+  }
+
+  // Initialize the coarse flux with the homogenized MOC flux
+  auto& flux = cflux_;
+  auto& new_flux = new_cflux_;
+  auto& VvEf = VvEf_;
+  auto& V = V_;
+  for (std::size_t G = 0; G < ng_; G++) {
+    for (std::size_t i = 0; i < nx_; i++) {
+      for (std::size_t j = 0; j < ny_; j++) {
+        const std::size_t c = this->tile_to_indx(i, j);
+        flux(indx(G, c)) = flux_(G, i, j);
+        V(indx(G, c)) = dx_[i] * dy_[j];
+        VvEf(indx(G, c)) = dx_[i] * dy_[j] * vEf_(G, i, j);
+      }
+    }
+  }
+  const double old_flux_sum = V.dot(flux);
+
+  // Jacobi preconditioner of the linear solves
+  for (Eigen::Index k = 0; k < M.rows(); k++) {
+    const double diag = M.coeff(k, k);
+    invs_diag_(k) = diag != 0. ? 1. / diag : 1.;
+  }
+
+  // Power iteration on the coarse problem
+  double keff = moc.keff_;
+  double keff_diff = 100.;
+  double flux_diff = 100.;
+  std::size_t iteration = 0;
+  while ((keff_diff > keff_tol_ || flux_diff > flux_tol_) &&
+         iteration < MAX_ITERATIONS) {
+    iteration++;
+
+    Q_.noalias() = F * flux;
+    Q_ *= 1. / keff;
+
+    new_flux = flux;
+    if (this->solve_loss_system(Q_, new_flux) == false) {
+      spdlog::warn("CMFD solution failed. Skipping CMFD acceleration.");
+      return;
+    }
+
+    const double prev_keff = keff;
+    keff = prev_keff * VvEf.dot(new_flux) / VvEf.dot(flux);
+    keff_diff = std::abs(keff - prev_keff) / keff;
+
+    new_flux *= prev_keff / keff;
+
+    flux_diff = 0.;
+    for (Eigen::Index i = 0; i < new_flux.size(); i++) {
+      const double flux_diff_i = std::abs(new_flux(i) - flux(i)) / new_flux(i);
+      if (flux_diff_i > flux_diff) flux_diff = flux_diff_i;
+    }
+    flux.swap(new_flux);
+  }
+
+  if (iteration == MAX_ITERATIONS) {
+    spdlog::warn("CMFD did not converge in {} iterations.", MAX_ITERATIONS);
+  }
+
+  if (std::isfinite(keff) == false || keff <= 0.) {
+    spdlog::warn("Invalid CMFD keff. Skipping CMFD acceleration.");
+    return;
+  }
+
+  // Keep the same total flux as the transport solution
+  flux *= old_flux_sum / V.dot(flux);
+
+  for (std::size_t G = 0; G < ng_; G++) {
+    for (std::size_t i = 0; i < nx_; i++) {
+      for (std::size_t j = 0; j < ny_; j++) {
+        cmfd_flux_(G, i, j) = flux(indx(G, this->tile_to_indx(i, j)));
+      }
+    }
+  }
+
+  this->update_moc_fluxes(moc, cmfd_flux_);
+  moc.keff_ = keff;
+}
+
+bool CMFD::solve_loss_system(const Eigen::VectorXd& b, Eigen::VectorXd& x) {
+  // Jacobi preconditioned BiCGSTAB, following the algorithm of
+  // Eigen::BiCGSTAB, but with the work vectors kept between solves. Starts
+  // from the initial guess in x, and returns false if the relative residual
+  // is not below LINEAR_TOLERANCE.
+  const auto& M = M_;
+  const double b_sqnorm = b.squaredNorm();
+  if (b_sqnorm == 0.) {
+    x.setZero();
+    return true;
+  }
+
+  const double tol2 = LINEAR_TOLERANCE * LINEAR_TOLERANCE * b_sqnorm;
+  const double eps2 = std::numeric_limits<double>::epsilon() *
+                      std::numeric_limits<double>::epsilon();
+  const Eigen::Index max_iters = 2 * M.cols();
+
+  r_.noalias() = M * x;
+  r_ = b - r_;
+  r0_ = r_;
+  double r0_sqnorm = r0_.squaredNorm();
+  double rho = 1., alpha = 1., w = 1.;
+  v_.setZero();
+  p_.setZero();
+
+  Eigen::Index iter = 0;
+  std::size_t restarts = 0;
+  while (r_.squaredNorm() > tol2 && iter < max_iters) {
+    const double rho_old = rho;
+    rho = r0_.dot(r_);
+    if (std::abs(rho) < eps2 * r0_sqnorm) {
+      // The residual has become orthogonal to r0, so the iteration restarts
+      r_.noalias() = M * x;
+      r_ = b - r_;
+      r0_ = r_;
+      rho = r0_sqnorm = r_.squaredNorm();
+      if (restarts++ == 0) iter = 0;
+    }
+
+    const double beta = (rho / rho_old) * (alpha / w);
+    p_ = r_ + beta * (p_ - w * v_);
+    y_ = invs_diag_.cwiseProduct(p_);
+    v_.noalias() = M * y_;
+    alpha = rho / r0_.dot(v_);
+    s_ = r_ - alpha * v_;
+    z_ = invs_diag_.cwiseProduct(s_);
+    t_.noalias() = M * z_;
+    const double t_sqnorm = t_.squaredNorm();
+    w = t_sqnorm > 0. ? t_.dot(s_) / t_sqnorm : 0.;
+    x += alpha * y_ + w * z_;
+    r_ = s_ - w * t_;
+    iter++;
+  }
+
+  return r_.squaredNorm() <= tol2;
+}
+
+void CMFD::update_moc_fluxes(MOCDriver& moc,
+                             const xt::xtensor<double, 3>& flux) {
+  // Compute the ratio of the new and old flux in each tile and group.
+  // Tiles where the coarse solution is not positive are left untouched.
+  auto& ratios = ratios_;
+  ratios.fill(1.);
+  for (std::size_t G = 0; G < ng_; G++) {
+    for (std::size_t i = 0; i < nx_; i++) {
+      for (std::size_t j = 0; j < ny_; j++) {
+        if (flux(G, i, j) > 0.) {
+          ratios(G, this->tile_to_indx(i, j)) = flux(G, i, j) / flux_(G, i, j);
+        }
+      }
+    }
+  }
+
+  // Update the scalar flux in all FSRs
+  const std::size_t NG = moc.ngroups();
+  const std::size_t NLJ = moc.flux_.shape()[2];
+  for (std::size_t t = 0; t < fsrs_.size(); t++) {
+    for (const auto fsr : fsrs_[t]) {
+      for (std::size_t g = 0; g < NG; g++) {
+        const double r = ratios(moc_to_cmfd_group_map_[g], t);
+        const std::size_t i = moc.internal_fsr_indx(fsr);
+        for (std::size_t lj = 0; lj < NLJ; lj++) moc.flux_(g, i, lj) *= r;
+      }
+    }
+  }
+
+  // Update the boundary angular fluxes of all tracks
+  for (auto& tracks : moc.tracks_) {
+    for (auto& track : tracks) {
+      if (track.num_segments() == 0) continue;
+
+      const std::size_t s_begin = track.segment_offset();
+      const std::size_t s_end = s_begin + track.num_segments();
+      // The CMFD FSR lists use the original FSR numbering
+      const std::size_t t_entry =
+          fsr_tiles_[moc.original_fsr_indx(moc.seg_fsrs_[s_begin])];
+      const std::size_t t_exit =
+          fsr_tiles_[moc.original_fsr_indx(moc.seg_fsrs_[s_end - 1])];
+      for (std::size_t g = 0; g < NG; g++) {
+        const std::size_t G = moc_to_cmfd_group_map_[g];
+        MOCReal* entry_flux = moc.boundary_flux(track.entry_flux_offset(), g);
+        MOCReal* exit_flux = moc.boundary_flux(track.exit_flux_offset(), g);
+        for (std::size_t p = 0; p < moc.n_pol_angles_; p++) {
+          entry_flux[p] =
+              static_cast<MOCReal>(entry_flux[p] * ratios(G, t_entry));
+          exit_flux[p] = static_cast<MOCReal>(exit_flux[p] * ratios(G, t_exit));
+        }
+      }
+    }
+  }
+
+  std::copy(flux.begin(), flux.end(), flux_.begin());
 }
 
-}  // namespace scarabee
\ No newline at end of file
+}  // namespace scarabee
@@ -2,6 +2,7 @@
 #include <utils/scarabee_exception.hpp>
 #include <utils/logging.hpp>
 #include <utils/timer.hpp>
+#include <utils/chebyshev_acceleration.hpp>
 
 #include <xtensor/xbuilder.hpp>
 
@@ -206,6 +207,7 @@ void CylindricalFluxSolver::solve_single_thread() {
 
   // Outer Generations
   double max_outer_flux_diff = 100.;
+  ChebyshevAcceleration chebyshev;
   while (std::abs((old_keff - k_) / k_) > k_tol_ ||
          max_outer_flux_diff > flux_tol_) {
     outer_iter++;
@@ -257,6 +259,14 @@ void CylindricalFluxSolver::solve_single_thread() {
       // Copy next_flux into flux for calculating next relative difference
       flux_ = next_flux;
     }  // End of Inner Iterations
+
+    // Extrapolate the outer generation
+    if (chebyshev_acceleration_ && mode_ == SimulationMode::Keff) {
+      chebyshev.extrapolate({old_outer_flux.data(), old_outer_flux.size()},
+                            {flux_.data(), flux_.size()});
+      next_flux = flux_;
+    }
+
     max_outer_flux_diff = calc_flux_rel_diff(old_outer_flux, flux_);
 
     if (mode_ == SimulationMode::Keff) {
@@ -317,6 +327,7 @@ void CylindricalFluxSolver::solve_parallel() {
 
   // Outer Generations
   double max_outer_flux_diff = 100.;
+  ChebyshevAcceleration chebyshev;
   while (std::abs((old_keff - k_) / k_) > k_tol_ ||
          max_outer_flux_diff > flux_tol_) {
     outer_iter++;
@@ -370,6 +381,14 @@ void CylindricalFluxSolver::solve_parallel() {
       // Copy next_flux into flux for calculating next relative difference
       flux_ = next_flux;
     }  // End of Inner Iterations
+
+    // Extrapolate the outer generation
+    if (chebyshev_acceleration_ && mode_ == SimulationMode::Keff) {
+      chebyshev.extrapolate({old_outer_flux.data(), old_outer_flux.size()},
+                            {flux_.data(), flux_.size()});
+      next_flux = flux_;
+    }
+
     max_outer_flux_diff = calc_flux_rel_diff(old_outer_flux, flux_);
 
     if (mode_ == SimulationMode::Keff) {
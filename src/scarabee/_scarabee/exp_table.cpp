@@ -0,0 +1,73 @@
+#include <moc/exp_table.hpp>
+#include <utils/logging.hpp>
+#include <utils/scarabee_exception.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace scarabee {
+
+ExpTable::ExpTable(double x_max, double tolerance)
+    : coeffs_(), dx_(), invs_dx_(), x_max_() {
+  if (x_max <= 0.) {
+    auto mssg = "Maximum argument of exponential table must be > 0.";
+    spdlog::error(mssg);
+    throw ScarabeeException(mssg);
+  }
+
+  if (tolerance <= 0.) {
+    auto mssg = "Tolerance of exponential table must be > 0.";
+    spdlog::error(mssg);
+    throw ScarabeeException(mssg);
+  }
+
+  // The truncation error of the second order expansion is bounded by
+  // max|f'''| dx^3 / 6, and |f'''(x)| = exp(-x) <= 1.
+  const double dx = std::cbrt(6. * tolerance);
+  const std::size_t N =
+      static_cast<std::size_t>(std::ceil(x_max / dx)) + 1;  // Grid points
+
+  dx_ = x_max / static_cast<double>(N - 1);
+  invs_dx_ = 1. / dx_;
+  x_max_ = x_max;
+
+  coeffs_.resize(3 * N);
+  for (std::size_t i = 0; i < N; i++) {
+    const double x = static_cast<double>(i) * dx_;
+    const double e = std::exp(-x);
+    coeffs_[3 * i] = 1. - e;        // f(x)
+    coeffs_[3 * i + 1] = e;         // f'(x)
+    coeffs_[3 * i + 2] = -0.5 * e;  // f''(x) / 2
+  }
+
+  this->split_coeffs();
+}
+
+void ExpTable::split_coeffs() {
+  const std::size_t N = this->size();
+  c0_.resize(N);
+  c1_.resize(N);
+  c2_.resize(N);
+  for (std::size_t i = 0; i < N; i++) {
+    c0_[i] = static_cast<MOCReal>(coeffs_[3 * i]);
+    c1_[i] = static_cast<MOCReal>(coeffs_[3 * i + 1]);
+    c2_[i] = static_cast<MOCReal>(coeffs_[3 * i + 2]);
+  }
+}
+
+double ExpTable::max_error() const {
+  double err = 0.;
+  constexpr std::size_t NSAMPLES = 4;
+  const double invs_NSAMPLES = 1. / static_cast<double>(NSAMPLES + 1);
+  for (std::size_t i = 0; i + 1 < this->size(); i++) {
+    for (std::size_t s = 1; s <= NSAMPLES; s++) {
+      const double x =
+          (static_cast<double>(i) + static_cast<double>(s) * invs_NSAMPLES) *
+          dx_;
+      err = std::max(err, std::abs((*this)(x) - (1. - std::exp(-x))));
+    }
+  }
+  return err;
+}
+
+}  // namespace scarabee
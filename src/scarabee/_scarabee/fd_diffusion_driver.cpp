@@ -437,6 +437,16 @@ void FDDiffusionDriver::set_keff_tolerance(double ktol) {
   keff_tol_ = ktol;
 }
 
+void FDDiffusionDriver::set_wielandt_shift(double shift) {
+  if (shift < 0.) {
+    auto mssg = "Wielandt shift must be >= 0.";
+    spdlog::error(mssg);
+    throw ScarabeeException(mssg);
+  }
+
+  wielandt_shift_ = shift;
+}
+
 void FDDiffusionDriver::solve() {
   Timer sim_timer;
   sim_timer.start();
@@ -444,6 +454,8 @@ void FDDiffusionDriver::solve() {
   spdlog::info("Solving for keff.");
   spdlog::info("keff tolerance: {:.5E}", keff_tol_);
   spdlog::info("Flux tolerance: {:.5E}", flux_tol_);
+  if (wielandt_shift_ > 0.)
+    spdlog::info("Wielandt shift: {:.5E}", wielandt_shift_);
 
   // First, we create our loss matrix
   Eigen::SparseMatrix<double, Eigen::RowMajor> M;
@@ -485,7 +497,14 @@ void FDDiffusionDriver::solve() {
     throw ScarabeeException(mssg.str());
   }
 
+  // Shifted loss matrix, only used once the Wielandt shift is active, and
+  // the shifted eigenvalue with which it was built
+  Eigen::SparseMatrix<double, Eigen::RowMajor> A;
+  double ks = 0.;
+  std::size_t nfactorizations = 0;
+
   // Begin power iteration
+  bool shifted = false;
   double keff_diff = 100.;
   double flux_diff = 100.;
   std::size_t iteration = 0;
@@ -495,8 +514,33 @@ void FDDiffusionDriver::solve() {
     iteration_timer.start();
     iteration++;
 
+    // The shift is only applied once keff is reasonably converged, as a poor
+    // estimate of keff can bring the shifted eigenvalue close to ks and make
+    // the shifted loss matrix nearly singular. Once on, it stays on.
+    if (wielandt_shift_ > 0. && keff_diff < WIELANDT_START_TOL) shifted = true;
+
+    // The power iteration converges with any fixed ks above keff, so the
+    // shifted matrix is kept until keff + shift has moved noticeably
+    const double new_ks = keff_ + wielandt_shift_;
+    if (shifted && (ks <= keff_ ||
+                    std::abs(new_ks - ks) > WIELANDT_REFACTOR_TOL * ks)) {
+      ks = new_ks;
+      A = M - (1. / ks) * QM;
+      solver.compute(A);
+      nfactorizations++;
+      if (solver.info() != Eigen::Success) {
+        auto mssg = "Could not initialize iterative solver";
+        spdlog::error(mssg);
+        throw ScarabeeException(mssg);
+      }
+    }
+
     // Compute source vector
-    Q = (1. / keff_) * QM * flux;
+    if (shifted) {
+      Q = (1. / keff_ - 1. / ks) * QM * flux;
+    } else {
+      Q = (1. / keff_) * QM * flux;
+    }
 
     // Get new flux
     new_flux = solver.solveWithGuess(Q, flux);
@@ -507,11 +551,16 @@ void FDDiffusionDriver::solve() {
 
     // Estiamte keff
     double prev_keff = keff_;
-    keff_ = prev_keff * VvEf.dot(new_flux) / VvEf.dot(flux);
+    const double R = VvEf.dot(new_flux) / VvEf.dot(flux);
+    if (shifted) {
+      keff_ = 1. / (1. / ks + (1. / prev_keff - 1. / ks) / R);
+    } else {
+      keff_ = prev_keff * R;
+    }
     keff_diff = std::abs(keff_ - prev_keff) / keff_;
 
     // Normalize our new flux
-    new_flux *= prev_keff / keff_;
+    new_flux /= R;
 
     // Find the max flux error
     flux_diff = 0.;
@@ -530,6 +579,10 @@ void FDDiffusionDriver::solve() {
                  iteration_timer.elapsed_time());
   }
 
+  if (shifted) {
+    spdlog::info("Shifted loss matrix factorizations: {}", nfactorizations);
+  }
+
   // Copy flux into the permanent xtensor array
   flux_.resize({geom_->ngroups() * geom_->nmats()});
   for (std::size_t i = 0; i < geom_->ngroups() * geom_->nmats(); i++) {
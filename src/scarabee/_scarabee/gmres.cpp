@@ -0,0 +1,114 @@
+#include <utils/gmres.hpp>
+
+#include <utils/logging.hpp>
+#include <utils/scarabee_exception.hpp>
+
+#include <cmath>
+
+namespace scarabee {
+
+GMRES::GMRES(std::size_t size, std::size_t restart) {
+  const Eigen::Index n = static_cast<Eigen::Index>(size);
+  const Eigen::Index m = static_cast<Eigen::Index>(restart);
+  V_.resize(n, m + 1);
+  H_.resize(m + 1, m);
+  cs_.resize(m);
+  sn_.resize(m);
+  g_.resize(m + 1);
+  y_.resize(m);
+  w_.resize(n);
+}
+
+std::size_t GMRES::memory() const {
+  const auto ndoubles = V_.size() + H_.size() + cs_.size() + sn_.size() +
+                        g_.size() + y_.size() + w_.size();
+  return static_cast<std::size_t>(ndoubles) * sizeof(double);
+}
+
+GMRESResult GMRES::solve(const LinearOperator& A, const Eigen::VectorXd& b,
+                         Eigen::VectorXd& x, std::size_t max_iters,
+                         double tol) {
+  if (b.size() != w_.size() || x.size() != w_.size()) {
+    auto mssg = "System size does not match the size of the GMRES solver.";
+    spdlog::error(mssg);
+    throw ScarabeeException(mssg);
+  }
+
+  GMRESResult res{0, 0, 0., false};
+
+  const double b_norm = b.norm();
+  if (b_norm == 0.) {
+    x.setZero();
+    res.converged = true;
+    return res;
+  }
+
+  const Eigen::Index m = H_.cols();
+
+  while (res.iterations < max_iters) {
+    A(x, w_);
+    res.operator_applications++;
+    w_ = b - w_;
+    const double beta = w_.norm();
+    res.residual = beta / b_norm;
+    if (res.residual <= tol) {
+      res.converged = true;
+      return res;
+    }
+
+    V_.col(0) = w_ / beta;
+    H_.setZero();
+    g_.setZero();
+    g_(0) = beta;
+
+    Eigen::Index k = 0;
+    while (k < m && res.iterations < max_iters) {
+      A(V_.col(k), w_);
+      res.operator_applications++;
+      res.iterations++;
+
+      // Modified Gram-Schmidt
+      for (Eigen::Index j = 0; j <= k; j++) {
+        H_(j, k) = V_.col(j).dot(w_);
+        w_ -= H_(j, k) * V_.col(j);
+      }
+      H_(k + 1, k) = w_.norm();
+      if (H_(k + 1, k) > 0.) V_.col(k + 1) = w_ / H_(k + 1, k);
+
+      // Apply the previous rotations to the new column
+      for (Eigen::Index j = 0; j < k; j++) {
+        const double tmp = cs_(j) * H_(j, k) + sn_(j) * H_(j + 1, k);
+        H_(j + 1, k) = -sn_(j) * H_(j, k) + cs_(j) * H_(j + 1, k);
+        H_(j, k) = tmp;
+      }
+
+      // Rotation zeroing the subdiagonal entry
+      const double denom = std::hypot(H_(k, k), H_(k + 1, k));
+      cs_(k) = denom > 0. ? H_(k, k) / denom : 1.;
+      sn_(k) = denom > 0. ? H_(k + 1, k) / denom : 0.;
+      H_(k, k) = denom;
+      H_(k + 1, k) = 0.;
+      g_(k + 1) = -sn_(k) * g_(k);
+      g_(k) = cs_(k) * g_(k);
+
+      k++;
+      res.residual = std::abs(g_(k)) / b_norm;
+      if (res.residual <= tol) break;
+    }
+
+    // Update the solution with the least squares solution in the subspace
+    y_.head(k) = g_.head(k);
+    H_.topLeftCorner(k, k).triangularView<Eigen::Upper>().solveInPlace(
+        y_.head(k));
+    x.noalias() += V_.leftCols(k) * y_.head(k);
+
+    if (res.residual <= tol) {
+      res.converged = true;
+      return res;
+    }
+  }
+
+  return res;
+}
+
+}  // namespace scarabee
@@ -118,9 +118,20 @@ class PWRAssembly {
     dancoff_polar_quadrature_ = pq;
   }
 
+  bool dancoff_modular_tracking() const { return dancoff_modular_tracking_; }
+  void set_dancoff_modular_tracking(bool modular) {
+    dancoff_modular_tracking_ = modular;
+  }
+
   bool plot_assembly() const { return plot_assembly_; }
   void set_plot_assembly(bool pa) { plot_assembly_ = pa; }
 
+  bool use_cmfd() const { return use_cmfd_; }
+  void set_use_cmfd(bool uc) { use_cmfd_ = uc; }
+
+  bool warm_start_moc() const { return warm_start_moc_; }
+  void set_warm_start_moc(bool ws) { warm_start_moc_ = ws; }
+
   double flux_tolerance() const { return flux_tolerance_; }
   void set_flux_tolerance(double ftol);
 
@@ -166,6 +177,7 @@ class PWRAssembly {
   std::uint32_t dancoff_num_azimuthal_angles_{64};
   double dancoff_track_spacing_{0.05};
   PolarQuadrature dancoff_polar_quadrature_{YamamotoTabuchi<6>()};
+  bool dancoff_modular_tracking_{false};
 
   // MOC parameters for assembly calculation
   std::uint32_t num_azimuthal_angles_{64};
@@ -175,6 +187,8 @@ class PWRAssembly {
   PolarQuadrature polar_quadrature_{YamamotoTabuchi<6>()};
   BoundaryCondition boundary_conditions_{BoundaryCondition::Reflective};
   bool anisotropic_{false};
+  bool use_cmfd_{false};
+  bool warm_start_moc_{false};  // Seed the MOC with the pin cell fluxes
 
   bool plot_assembly_{false};
   std::shared_ptr<Cartesian2D> moc_geom_{nullptr};
@@ -192,18 +206,21 @@ class PWRAssembly {
   std::vector<std::shared_ptr<CylindricalFluxSolver>> pin_1d_fluxes;
   std::shared_ptr<CrossSection> avg_fp_{nullptr};
 
-  void get_fuel_dancoff_corrections();
-  void get_clad_dancoff_corrections();
+  void get_dancoff_corrections();
   void pin_cell_calc();
   void condense_xs();
   void moc_calc();
+  void seed_moc_flux();
   void criticality_spectrum();
   void compute_form_factors();
   void few_group_xs();
   void compute_adf_cdf();
 
-  enum class DancoffMaterial { Fuel, Clad };
-  double isolated_fuel_pin_flux(DancoffMaterial dm) const;
+  // The fuel and clad Dancoff problems share the same geometry, and are
+  // solved together as the groups of a single fixed-source problem
+  static constexpr std::size_t FUEL_DANCOFF_GROUP{0};
+  static constexpr std::size_t CLAD_DANCOFF_GROUP{1};
+  std::vector<double> isolated_fuel_pin_fluxes() const;
   double isolated_guide_tube_flux() const;
   double isolated_burnable_poison_tube_flux() const;
 
@@ -222,13 +239,15 @@ class PWRAssembly {
         CEREAL_NVP(dancoff_num_azimuthal_angles_),
         CEREAL_NVP(dancoff_track_spacing_),
         CEREAL_NVP(dancoff_polar_quadrature_),
+        CEREAL_NVP(dancoff_modular_tracking_),
         CEREAL_NVP(num_azimuthal_angles_), CEREAL_NVP(track_spacing_),
         CEREAL_NVP(keff_tolerance_), CEREAL_NVP(flux_tolerance_),
         CEREAL_NVP(polar_quadrature_), CEREAL_NVP(boundary_conditions_),
-        CEREAL_NVP(anisotropic_), CEREAL_NVP(plot_assembly_),
-        CEREAL_NVP(moc_geom_), CEREAL_NVP(moc_), CEREAL_NVP(diffusion_xs_),
-        CEREAL_NVP(form_factors_), CEREAL_NVP(adf_), CEREAL_NVP(cdf_),
-        CEREAL_NVP(fuel_dancoff_corrections_),
+        CEREAL_NVP(anisotropic_), CEREAL_NVP(use_cmfd_),
+        CEREAL_NVP(warm_start_moc_), CEREAL_NVP(plot_assembly_),
+        CEREAL_NVP(moc_geom_), CEREAL_NVP(moc_),
+        CEREAL_NVP(diffusion_xs_), CEREAL_NVP(form_factors_), CEREAL_NVP(adf_),
+        CEREAL_NVP(cdf_), CEREAL_NVP(fuel_dancoff_corrections_),
         CEREAL_NVP(clad_dancoff_corrections_),
         CEREAL_NVP(criticality_spectrum_method_),
         CEREAL_NVP(criticality_spectrum_), CEREAL_NVP(pin_1d_cells),
@@ -60,6 +60,11 @@ class CylindricalFluxSolver {
   double keff_tolerance() const { return k_tol_; }
   void set_keff_tolerance(double ktol);
 
+  bool chebyshev_acceleration() const { return chebyshev_acceleration_; }
+  void set_chebyshev_acceleration(bool accelerate) {
+    chebyshev_acceleration_ = accelerate;
+  }
+
   double albedo() const { return a_; }
   void set_albedo(double a);
 
@@ -95,6 +100,7 @@ class CylindricalFluxSolver {
   double flux_tol_;
   SimulationMode mode_;
   bool solved_;
+  bool chebyshev_acceleration_{false};
 
   double calc_keff(const xt::xtensor<double, 2>& flux) const;
   double calc_flux_rel_diff(const xt::xtensor<double, 2>& flux,
@@ -118,7 +124,7 @@ class CylindricalFluxSolver {
     arc(CEREAL_NVP(flux_), CEREAL_NVP(extern_source_), CEREAL_NVP(j_ext_),
         CEREAL_NVP(x_), CEREAL_NVP(cell_), CEREAL_NVP(k_), CEREAL_NVP(a_),
         CEREAL_NVP(k_tol_), CEREAL_NVP(flux_tol_), CEREAL_NVP(mode_),
-        CEREAL_NVP(solved_));
+        CEREAL_NVP(solved_), CEREAL_NVP(chebyshev_acceleration_));
   }
 };
 
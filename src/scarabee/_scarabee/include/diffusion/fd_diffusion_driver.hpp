@@ -34,6 +34,9 @@ class FDDiffusionDriver {
   double flux_tolerance() const { return flux_tol_; }
   void set_flux_tolerance(double ftol);
 
+  double wielandt_shift() const { return wielandt_shift_; }
+  void set_wielandt_shift(double shift);
+
   double keff() const { return keff_; }
 
   std::tuple<xt::xarray<double>, xt::xarray<double>,
@@ -55,14 +58,23 @@ class FDDiffusionDriver {
   double keff_ = 1.;
   double flux_tol_ = 1.E-5;
   double keff_tol_ = 1.E-5;
+  double wielandt_shift_ = 0.;  // Shift added to keff, 0 to disable
   bool solved_{false};
 
+  // The shift is only applied once keff has converged to this tolerance, so
+  // that the shifted eigenvalue stays above the fundamental one
+  static constexpr double WIELANDT_START_TOL{1.E-3};
+  // The shifted loss matrix is only rebuilt and refactored once the shifted
+  // eigenvalue has changed by more than this relative amount
+  static constexpr double WIELANDT_REFACTOR_TOL{1.E-4};
+
   friend class cereal::access;
   FDDiffusionDriver() {}
   template <class Archive>
   void serialize(Archive& arc) {
     arc(CEREAL_NVP(geom_), CEREAL_NVP(flux_), CEREAL_NVP(keff_),
-        CEREAL_NVP(flux_tol_), CEREAL_NVP(keff_tol_), CEREAL_NVP(solved_));
+        CEREAL_NVP(flux_tol_), CEREAL_NVP(keff_tol_),
+        CEREAL_NVP(wielandt_shift_), CEREAL_NVP(solved_));
   }
 };
 
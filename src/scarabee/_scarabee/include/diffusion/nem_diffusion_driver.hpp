@@ -51,8 +51,16 @@ class NEMDiffusionDriver {
   double flux_tolerance() const { return flux_tol_; }
   void set_flux_tolerance(double ftol);
 
+  bool chebyshev_acceleration() const { return chebyshev_acceleration_; }
+  void set_chebyshev_acceleration(bool accelerate) {
+    chebyshev_acceleration_ = accelerate;
+  }
+
   double keff() const { return keff_; }
 
+  // Number of outer iterations of the last solve
+  std::size_t iterations() const { return iterations_; }
+
   double flux(double x, double y, double z, std::size_t g) const;
   xt::xtensor<double, 4> flux(const xt::xtensor<double, 1>& x,
                               const xt::xtensor<double, 1>& y,
@@ -129,7 +137,9 @@ class NEMDiffusionDriver {
   double keff_ = 1.;
   double flux_tol_ = 1.E-5;
   double keff_tol_ = 1.E-5;
+  bool chebyshev_acceleration_{false};
   bool solved_{false};
+  std::size_t iterations_{0};  // Outer iterations of the last solve
 
   //----------------------------------------------------------------------------
   // PRIVATE METHODS
@@ -248,7 +258,8 @@ class NEMDiffusionDriver {
         CEREAL_NVP(j_in_out_), CEREAL_NVP(Rmats_), CEREAL_NVP(Pmats_),
         CEREAL_NVP(Q_), CEREAL_NVP(neighbors_), CEREAL_NVP(geom_inds_),
         CEREAL_NVP(mats_), CEREAL_NVP(adf_), CEREAL_NVP(keff_),
-        CEREAL_NVP(flux_tol_), CEREAL_NVP(keff_tol_), CEREAL_NVP(solved_),
+        CEREAL_NVP(flux_tol_), CEREAL_NVP(keff_tol_),
+        CEREAL_NVP(chebyshev_acceleration_), CEREAL_NVP(solved_),
         CEREAL_NVP(recon_params));
   }
 };
@@ -101,27 +101,16 @@ class Cartesian2D {
 
   std::optional<TileIndex> get_tile_index(const Vector& r,
                                           const Direction& u) const {
-    for (std::size_t i = 0; i < nx(); i++) {
-      for (std::size_t j = 0; j < ny(); j++) {
-        // Get the surfaces that make up our tile
-        const auto& xl = x_bounds_[i];
-        const auto& xh = x_bounds_[i + 1];
-        const auto& yl = y_bounds_[j];
-        const auto& yh = y_bounds_[j + 1];
-
-        // Check if we are in the tile. If so, return index
-        if (xl->side(r, u) == Surface::Side::Positive &&
-            xh->side(r, u) == Surface::Side::Negative &&
-            yl->side(r, u) == Surface::Side::Positive &&
-            yh->side(r, u) == Surface::Side::Negative) {
-          return TileIndex{i, j};
-        }
-      }
-    }
+    // The x and y bounds can be searched independently, as a point is in
+    // tile (i, j) exactly when it is between x bounds i and i+1, and
+    // between y bounds j and j+1.
+    const auto i = find_bound_interval(x_bounds_, r.x(), true, r, u);
+    if (i.has_value() == false) return std::nullopt;
+
+    const auto j = find_bound_interval(y_bounds_, r.y(), false, r, u);
+    if (j.has_value() == false) return std::nullopt;
 
-    // If we get here, we weren't in any tile.
-    // Return nullopt
-    return std::nullopt;
+    return TileIndex{*i, *j};
   }
 
   Vector get_tile_center(const TileIndex& ti) const {
@@ -139,6 +128,15 @@ class Cartesian2D {
     return tiles_(ti.i, ti.j);
   }
 
+  // Offset added to the instance of the FSR with the given id, when it is
+  // located in tile ti.
+  std::size_t fsr_instance_offset(const TileIndex& ti, std::size_t id) const {
+    return fsr_offset_map_(ti.i, ti.j).find(id)->second;
+  }
+
+  // Widths of the tiles along x and y, if all tiles have the same size
+  std::optional<std::pair<double, double>> uniform_tile_size() const;
+
   void set_tiles(const std::vector<TileFill>& fills);
 
   bool tiles_valid() const;
@@ -197,6 +195,15 @@ class Cartesian2D {
 
   std::size_t num_fsrs() const;
 
+  // Layout of the geometry (bounds, surfaces, volumes, and the relative
+  // ordering of the FSR ids) flattened into a list of numbers. Geometries
+  // with the same layout have the same tracks. Cross sections are not
+  // included.
+  std::vector<double> geometry_layout() const;
+
+  // Hash of the layout of the geometry
+  std::size_t geometry_hash() const;
+
   std::size_t ngroups() const { return tiles_[0].ngroups(); }
 
   double x_min() const { return x_bounds_.front()->x0(); }
@@ -218,6 +225,10 @@ class Cartesian2D {
   void set_tile(const TileIndex& ti, const std::shared_ptr<Cell>& cell);
   std::pair<double, double> tile_dx_dy(const TileIndex& ti) const;
 
+  static std::optional<std::size_t> find_bound_interval(
+      const std::vector<std::shared_ptr<Surface>>& bounds, double coord,
+      bool x_axis, const Vector& r, const Direction& u);
+
   void check_tile_index(const TileIndex& ti) const {
     if (ti.i >= nx_) {
       auto mssg = "TileIndex i out of range.";
@@ -235,6 +246,8 @@ class Cartesian2D {
   // Methods for getting offset map
   void make_offset_map();
 
+  void append_layout(std::vector<double>& layout, std::size_t min_id) const;
+
   friend class cereal::access;
   template <class Archive>
   void serialize(Archive& arc) {
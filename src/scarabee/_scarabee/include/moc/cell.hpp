@@ -16,6 +16,7 @@
 #include <cereal/types/vector.hpp>
 
 #include <cmath>
+#include <limits>
 #include <map>
 #include <memory>
 #include <set>
@@ -44,11 +45,19 @@ class Cell {
   }
 
   UniqueFSR get_fsr(const Vector& r, const Direction& u) const {
-    std::stringstream mssg;
     if (this->inside(r, u) == false) {
       return {nullptr, 0};
     }
 
+    if (const FlatSourceRegion* fsr = this->lookup_fsr(r, u)) return {fsr, 0};
+
+    return this->search_fsr(r, u);
+  }
+
+  // Finds the FSR by testing every FSR of the cell in turn, without the
+  // lookup. The position must be inside the cell.
+  UniqueFSR search_fsr(const Vector& r, const Direction& u) const {
+    std::stringstream mssg;
     for (const auto& fsr : fsrs_) {
       if (fsr.inside(r, u)) return {&fsr, 0};
     }
@@ -84,13 +93,39 @@ class Cell {
   Cell(double dx, double dy);
   void check_surfaces() const;
 
+  // Builds the FSR lookup of cells made of rings around a common center,
+  // which may be split into angular sectors. Must be called once all FSRs
+  // have been built. Cells without cylinders keep the linear search.
+  void build_fsr_lookup();
+
   friend class cereal::access;
   Cell() {}
   template <class Archive>
   void serialize(Archive& arc) {
     arc(CEREAL_NVP(fsrs_), CEREAL_NVP(x_min_), CEREAL_NVP(y_min_),
         CEREAL_NVP(x_max_), CEREAL_NVP(y_max_));
+
+    // The lookup only depends on the FSRs, and is rebuilt when loading
+    if constexpr (Archive::is_loading::value) this->build_fsr_lookup();
   }
+
+ private:
+  // FSR lookup. A point is placed in a ring by a binary search on its
+  // squared distance to the center, and in one of 8 octants around the
+  // center. The FSR found for that ring and octant is then verified with the
+  // full CSG test, followed by the other FSRs of the ring, so that the result
+  // is always the same as the linear search.
+  static constexpr std::size_t NUM_OCTANTS{8};
+  static constexpr std::size_t NO_FSR{std::numeric_limits<std::size_t>::max()};
+  double lookup_x0_{0.}, lookup_y0_{0.};
+  std::vector<double> lookup_radii2_;  // Squared radii of the rings, sorted
+  // FSRs in each ring, the last one lying outside all radii
+  std::vector<std::vector<std::size_t>> ring_fsrs_;
+  // FSR of each ring and octant, indexed by ring * NUM_OCTANTS + octant
+  std::vector<std::size_t> sector_fsrs_;
+
+  const FlatSourceRegion* lookup_fsr(const Vector& r,
+                                     const Direction& u) const;
 };
 
 }  // namespace scarabee
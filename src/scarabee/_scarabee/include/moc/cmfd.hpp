@@ -0,0 +1,178 @@
+#ifndef CMFD_H
+#define CMFD_H
+
+#include <moc/surface.hpp>
+#include <moc/vector.hpp>
+#include <moc/direction.hpp>
+#include <data/diffusion_cross_section.hpp>
+#include <utils/serialization.hpp>
+
+#include <xtensor/xtensor.hpp>
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+
+#include <cereal/cereal.hpp>
+#include <cereal/types/set.hpp>
+#include <cereal/types/utility.hpp>
+#include <cereal/types/vector.hpp>
+
+#include <array>
+#include <memory>
+#include <optional>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace scarabee {
+
+class MOCDriver;
+
+class CMFD {
+ public:
+  CMFD(const std::vector<double>& dx, const std::vector<double>& dy,
+       const std::vector<std::pair<std::size_t, std::size_t>>& groups);
+
+  std::size_t nx() const { return nx_; }
+  std::size_t ny() const { return ny_; }
+  std::size_t ngroups() const { return ng_; }
+  std::size_t nmoc_groups() const { return moc_to_cmfd_group_map_.size(); }
+
+  double x_min() const { return x_bounds_.front().x0(); }
+  double x_max() const { return x_bounds_.back().x0(); }
+  double y_min() const { return y_bounds_.front().y0(); }
+  double y_max() const { return y_bounds_.back().y0(); }
+
+  const std::vector<std::pair<std::size_t, std::size_t>>& group_condensation()
+      const {
+    return group_condensation_;
+  }
+
+  double keff_tolerance() const { return keff_tol_; }
+  void set_keff_tolerance(double ktol);
+
+  double flux_tolerance() const { return flux_tol_; }
+  void set_flux_tolerance(double ftol);
+
+  std::optional<std::array<std::size_t, 2>> get_tile(const Vector& r,
+                                                     const Direction& u) const;
+
+  std::optional<std::size_t> get_surface(const Vector& r,
+                                         const Direction& u) const;
+
+  std::size_t tile_to_indx(const std::array<std::size_t, 2>& tile) const;
+  std::size_t tile_to_indx(const std::size_t& i, const std::size_t& j) const;
+
+  void insert_fsr(const std::array<std::size_t, 2>& tile, std::size_t fsr);
+  void reset_fsr_lists();
+  void pack_fsr_lists();
+  const std::vector<std::size_t>& fsrs(const std::size_t i,
+                                       const std::size_t j) const;
+
+  std::size_t moc_to_cmfd_group(std::size_t g) const;
+
+  double& current(const std::size_t G, const std::size_t surface);
+  const double& current(const std::size_t G, const std::size_t surface) const;
+
+  void tally_current(double aflx, const Direction& u, std::size_t G,
+                     const std::size_t surf);
+  void zero_currents();
+
+  double flux(const std::size_t i, const std::size_t j,
+              const std::size_t G) const {
+    return flux_(G, i, j);
+  }
+
+  void solve(MOCDriver& moc);
+
+ private:
+  std::vector<double> dx_;
+  std::vector<double> dy_;
+  std::vector<Surface> x_bounds_;
+  std::vector<Surface> y_bounds_;
+  std::vector<std::size_t> moc_to_cmfd_group_map_;
+  std::vector<std::pair<std::size_t, std::size_t>> group_condensation_;
+  std::size_t nx_, ny_, ng_;
+  std::size_t nx_surfs_;  // Number of surfaces normal to the x axis
+  std::size_t ny_surfs_;  // Number of surfaces normal to the y axis
+
+  // List of FSR indices in each CMFD tile. The temp_fsrs_ is filled during
+  // ray tracing, and then packed into fsrs_ which is used for the solution.
+  std::vector<std::set<std::size_t>> temp_fsrs_;
+  std::vector<std::vector<std::size_t>> fsrs_;
+  std::vector<std::size_t> fsr_tiles_;  // Tile index of each FSR
+
+  xt::xtensor<double, 2> surface_currents_;  // Indexed by group, surface
+  bool surface_currents_normalized_{false};
+
+  // Homogenized and condensed cross sections of each tile, indexed by group,
+  // x, y. The scattering matrix is indexed by incoming group, outgoing group,
+  // x, y.
+  xt::xtensor<double, 3> D_;
+  xt::xtensor<double, 3> Er_;
+  xt::xtensor<double, 3> vEf_;
+  xt::xtensor<double, 3> chi_;
+  xt::xtensor<double, 4> Es_;
+  xt::xtensor<double, 3> flux_;  // Indexed by group, x, y
+  double keff_tol_ = 1.E-6;
+  double flux_tol_ = 1.E-6;
+
+  // Work arrays of the coarse problem. They are allocated with the CMFD mesh,
+  // so that a solve does not allocate. The loss and fission matrices keep the
+  // same sparsity pattern, and only their values are refilled.
+  using SparseMatrix = Eigen::SparseMatrix<double, Eigen::RowMajor>;
+  SparseMatrix M_;
+  SparseMatrix F_;
+  Eigen::VectorXd cflux_, new_cflux_, Q_, V_, VvEf_;
+  // Jacobi preconditioner and vectors of the BiCGSTAB iterations
+  Eigen::VectorXd invs_diag_, r_, r0_, p_, v_, s_, t_, y_, z_;
+  // Fine group flux x volume, Etr reaction rate, and fission spectrum of the
+  // tile being homogenized
+  xt::xtensor<double, 1> fine_flux_;
+  xt::xtensor<double, 1> fine_Etr_;
+  xt::xtensor<double, 1> fine_chi_;
+  xt::xtensor<double, 3> cmfd_flux_;  // Accelerated coarse flux
+  xt::xtensor<double, 2> ratios_;     // Indexed by group, tile
+
+  void allocate_work_arrays();
+  void normalize_currents();
+  void compute_homogenized_xs_and_flux(const MOCDriver& moc);
+  void calc_surface_coefficients(std::size_t G, std::size_t surf,
+                                 const std::optional<std::size_t>& neg,
+                                 const std::optional<std::size_t>& pos,
+                                 double h_neg, double h_pos, double& Dt,
+                                 double& Dh) const;
+  bool solve_loss_system(const Eigen::VectorXd& b, Eigen::VectorXd& x);
+  void update_moc_fluxes(MOCDriver& moc, const xt::xtensor<double, 3>& flux);
+
+  friend class cereal::access;
+  CMFD() {}
+  template <class Archive>
+  void save(Archive& arc) const {
+    arc(CEREAL_NVP(dx_), CEREAL_NVP(dy_), CEREAL_NVP(x_bounds_),
+        CEREAL_NVP(y_bounds_), CEREAL_NVP(moc_to_cmfd_group_map_),
+        CEREAL_NVP(group_condensation_), CEREAL_NVP(nx_), CEREAL_NVP(ny_),
+        CEREAL_NVP(ng_), CEREAL_NVP(nx_surfs_), CEREAL_NVP(ny_surfs_),
+        CEREAL_NVP(temp_fsrs_), CEREAL_NVP(fsrs_), CEREAL_NVP(fsr_tiles_),
+        CEREAL_NVP(surface_currents_), CEREAL_NVP(flux_),
+        CEREAL_NVP(keff_tol_), CEREAL_NVP(flux_tol_));
+  }
+
+  template <class Archive>
+  void load(Archive& arc) {
+    arc(CEREAL_NVP(dx_), CEREAL_NVP(dy_), CEREAL_NVP(x_bounds_),
+        CEREAL_NVP(y_bounds_), CEREAL_NVP(moc_to_cmfd_group_map_),
+        CEREAL_NVP(group_condensation_), CEREAL_NVP(nx_), CEREAL_NVP(ny_),
+        CEREAL_NVP(ng_), CEREAL_NVP(nx_surfs_), CEREAL_NVP(ny_surfs_),
+        CEREAL_NVP(temp_fsrs_), CEREAL_NVP(fsrs_), CEREAL_NVP(fsr_tiles_),
+        CEREAL_NVP(surface_currents_), CEREAL_NVP(flux_),
+        CEREAL_NVP(keff_tol_), CEREAL_NVP(flux_tol_));
+
+    // Homogenized cross sections are rebuilt on each solve
+    this->allocate_work_arrays();
+  }
+};
+
+}  // namespace scarabee
+
+#endif
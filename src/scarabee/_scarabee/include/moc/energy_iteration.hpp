@@ -0,0 +1,13 @@
+#ifndef ENERGY_ITERATION_H
+#define ENERGY_ITERATION_H
+
+#include <cstdint>
+
+namespace scarabee {
+
+// Update of the energy groups in an outer iteration of the MOC solver
+enum class EnergyIteration : std::uint8_t { Jacobi, GaussSeidel };
+
+}
+
+#endif
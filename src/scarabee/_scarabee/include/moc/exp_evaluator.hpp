@@ -0,0 +1,13 @@
+#ifndef EXP_EVALUATOR_H
+#define EXP_EVALUATOR_H
+
+#include <cstdint>
+
+namespace scarabee {
+
+// Method used to evaluate 1 - exp(-x) in the MOC sweep
+enum class ExpEvaluator : std::uint8_t { Rational, Table };
+
+}
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef EXP_TABLE_H
+#define EXP_TABLE_H
+
+#include <moc/precision.hpp>
+
+#include <xsimd/xsimd.hpp>
+
+#include <cereal/cereal.hpp>
+#include <cereal/types/vector.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace scarabee {
+
+// Tabulation of 1 - exp(-x) on [0, x_max], evaluated with a second order
+// expansion about the nearest lower grid point. Arguments beyond x_max are
+// evaluated directly.
+class ExpTable {
+ public:
+  ExpTable() = default;
+  ExpTable(double x_max, double tolerance = 1.E-8);
+
+  double operator()(double x) const {
+    if (x >= x_max_) return 1. - std::exp(-x);
+    const std::size_t i = static_cast<std::size_t>(x * invs_dx_);
+    const double h = x - static_cast<double>(i) * dx_;
+    const double* c = &coeffs_[3 * i];
+    return c[0] + h * (c[1] + h * c[2]);
+  }
+
+  // Same, for a SIMD batch of arguments. The grid indices are computed for
+  // all lanes at once, and the coefficients of each lane are gathered from
+  // the table.
+  xsimd::batch<MOCReal> operator()(const xsimd::batch<MOCReal>& x) const {
+    using batch = xsimd::batch<MOCReal>;
+    using index_batch = xsimd::as_integer_t<batch>;
+    using index_type = typename index_batch::value_type;
+    const index_batch i =
+        xsimd::min(xsimd::to_int(x * batch(static_cast<MOCReal>(invs_dx_))),
+                   index_batch(static_cast<index_type>(c0_.size() - 1)));
+    const batch h = x - xsimd::to_float(i) * batch(static_cast<MOCReal>(dx_));
+    const batch c0 = batch::gather(c0_.data(), i);
+    const batch c1 = batch::gather(c1_.data(), i);
+    const batch c2 = batch::gather(c2_.data(), i);
+    const batch out = xsimd::fma(h, xsimd::fma(h, c2, c1), c0);
+
+    const auto beyond = x >= batch(static_cast<MOCReal>(x_max_));
+    if (xsimd::any(beyond)) {
+      return xsimd::select(beyond, batch(MOCReal(1.)) - xsimd::exp(-x), out);
+    }
+    return out;
+  }
+
+  double x_max() const { return x_max_; }
+  double dx() const { return dx_; }
+  std::size_t size() const { return coeffs_.size() / 3; }
+
+  // Theoretical upper bound of the interpolation error
+  double error_bound() const { return dx_ * dx_ * dx_ / 6.; }
+
+  // Maximum error found by sampling the table between grid points
+  double max_error() const;
+
+ private:
+  std::vector<double> coeffs_;  // Three coefficients for each grid point
+  // Coefficients of each order, in MOCReal, gathered by the batch evaluation
+  std::vector<MOCReal> c0_, c1_, c2_;
+  double dx_{0.};
+  double invs_dx_{0.};
+  double x_max_{0.};
+
+  friend class cereal::access;
+  template <class Archive>
+  void serialize(Archive& arc) {
+    arc(CEREAL_NVP(coeffs_), CEREAL_NVP(dx_), CEREAL_NVP(invs_dx_),
+        CEREAL_NVP(x_max_));
+
+    // The batch coefficients are rebuilt when loading
+    if constexpr (Archive::is_loading::value) this->split_coeffs();
+  }
+
+  void split_coeffs();
+};
+
+}  // namespace scarabee
+
+#endif
@@ -3,25 +3,55 @@
 
 #include <moc/cartesian_2d.hpp>
 #include <moc/boundary_condition.hpp>
+#include <moc/cmfd.hpp>
+#include <moc/energy_iteration.hpp>
+#include <moc/exp_evaluator.hpp>
+#include <moc/exp_table.hpp>
 #include <moc/flat_source_region.hpp>
+#include <moc/precision.hpp>
+#include <moc/segment_encoding.hpp>
+#include <moc/sweep_parallelism.hpp>
 #include <moc/track.hpp>
+#include <moc/tracking_cache.hpp>
+#include <moc/transport_solver.hpp>
 #include <moc/quadrature/polar_quadrature.hpp>
 #include <utils/simulation_mode.hpp>
 #include <utils/spherical_harmonics.hpp>
 #include <utils/serialization.hpp>
+#include <utils/load_balance.hpp>
 
 #include <xtensor/xtensor.hpp>
+#include <xsimd/xsimd.hpp>
+
+#include <Eigen/Dense>
 
 #include <cereal/cereal.hpp>
 #include <cereal/types/vector.hpp>
 #include <cereal/types/memory.hpp>
 
+#include <cstdint>
+#include <limits>
 #include <map>
 #include <memory>
+#include <tuple>
 #include <vector>
 
 namespace scarabee {
 
+// SIMD batch of the MOC sweeps, which holds MOCReal values, so that the
+// mixed precision build processes twice as many polar angles per batch
+using MOCBatch = xsimd::batch<MOCReal>;
+
+// Estimate of the memory required by the tracks of a MOCDriver, in bytes.
+// The number of segments is extrapolated from a sample of traced tracks.
+struct TrackingMemory {
+  std::size_t num_tracks;
+  std::size_t num_segments;
+  std::size_t track_memory;       // Tracks and boundary fluxes (both modes)
+  std::size_t stored_memory;      // Segments stored for all tracks
+  std::size_t on_the_fly_memory;  // Data for tracing segments on the fly
+};
+
 class MOCDriver {
  public:
   MOCDriver(std::shared_ptr<Cartesian2D> geometry,
@@ -43,20 +73,89 @@ class MOCDriver {
 
   double keff() const { return keff_; }
 
+  // Seeds the next solve with the scalar flux, keff, and track boundary
+  // angular fluxes of another solved driver with the same tracking
+  void set_initial_flux(const MOCDriver& other);
+  // Same as above, with a driver saved by save_bin
+  void set_initial_flux(const std::string& fname);
+  // Seeds the next solve with a scalar flux indexed by group then FSR, and
+  // with keff. The boundary angular fluxes are taken to be isotropic, using
+  // the flux of the FSR at each end of the track.
+  void set_initial_flux(const xt::xtensor<double, 2>& flux, double keff);
+  bool warm_start() const { return warm_start_; }
+
   SimulationMode& sim_mode() { return mode_; }
   const SimulationMode& sim_mode() const { return mode_; }
 
+  ExpEvaluator& exp_evaluator() { return exp_evaluator_; }
+  const ExpEvaluator& exp_evaluator() const { return exp_evaluator_; }
+
+  const ExpTable& exp_table() const { return exp_table_; }
+
+  SweepParallelism& sweep_parallelism() { return sweep_parallelism_; }
+  const SweepParallelism& sweep_parallelism() const {
+    return sweep_parallelism_;
+  }
+
+  std::size_t group_block_size() const { return group_block_size_; }
+  void set_group_block_size(std::size_t block_size);
+
+  EnergyIteration& energy_iteration() { return energy_iteration_; }
+  const EnergyIteration& energy_iteration() const { return energy_iteration_; }
+
+  std::size_t upscatter_iterations() const { return upscatter_iterations_; }
+  void set_upscatter_iterations(std::size_t iterations);
+
+  TransportSolver& transport_solver() { return transport_solver_; }
+  const TransportSolver& transport_solver() const { return transport_solver_; }
+
+  std::size_t krylov_restart() const { return krylov_restart_; }
+  void set_krylov_restart(std::size_t restart);
+
+  bool chebyshev_acceleration() const { return chebyshev_acceleration_; }
+  void set_chebyshev_acceleration(bool accelerate) {
+    chebyshev_acceleration_ = accelerate;
+  }
+
+  // Time spent by each thread in the sweeps of the last solve
+  const std::vector<double>& thread_busy_time() const {
+    return sweep_busy_time_.times();
+  }
+
+  bool renumber_fsrs() const { return renumber_fsrs_; }
+  void set_renumber_fsrs(bool renumber) { renumber_fsrs_ = renumber; }
+
+  bool use_tracking_cache() const { return use_tracking_cache_; }
+  void set_use_tracking_cache(bool use) { use_tracking_cache_ = use; }
+
+  bool modular_tracking() const { return modular_tracking_; }
+  void set_modular_tracking(bool modular) { modular_tracking_ = modular; }
+
+  bool on_the_fly_tracking() const { return on_the_fly_tracking_; }
+  void set_on_the_fly_tracking(bool on_the_fly);
+
+  SegmentEncoding segment_encoding() const { return segment_encoding_; }
+  void set_segment_encoding(SegmentEncoding encoding);
+
   double keff_tolerance() const { return keff_tol_; }
   void set_keff_tolerance(double ktol);
 
   double flux_tolerance() const { return flux_tol_; }
   void set_flux_tolerance(double ftol);
 
+  std::shared_ptr<CMFD> cmfd() const { return cmfd_; }
+  void set_cmfd(std::shared_ptr<CMFD> cmfd);
+
   void generate_tracks(std::uint32_t n_angles, double d,
                        PolarQuadrature polar_quad);
 
+  TrackingMemory estimate_tracking_memory(std::uint32_t n_angles, double d,
+                                          PolarQuadrature polar_quad) const;
+
   void solve();
   bool solved() const { return solved_; }
+  // Number of outer iterations of the last solve
+  std::size_t iterations() const { return iterations_; }
 
   std::shared_ptr<CrossSection> homogenize() const;
   std::shared_ptr<CrossSection> homogenize(
@@ -143,13 +242,47 @@ class MOCDriver {
   std::vector<AngleInfo> angle_info_;       // Information for all angles
   std::vector<std::vector<Track>> tracks_;  // All tracks, indexed by angle
   std::shared_ptr<Cartesian2D> geometry_;   // Geometry for the problem
+  std::shared_ptr<CMFD> cmfd_;              // Optional CMFD acceleration
   PolarQuadrature polar_quad_;              // Polar quadrature
   SphericalHarmonics sph_harm_;             // Spherical harmonics
   xt::xtensor<double, 3>
       flux_;  // Indexed by group, FSR, and spherical harmonic
   xt::xtensor<double, 2> extern_src_;  // Indexed by group then FSR
   std::vector<const FlatSourceRegion*> fsrs_;
+  // Flattened segment data for all tracks, used by the sweeps. The segments
+  // of a track start at Track::segment_offset().
+  std::vector<MOCReal> seg_lengths_;
+  std::vector<std::uint32_t> seg_fsrs_;
+  std::vector<std::uint32_t> seg_entry_cmfd_;  // Only filled when using CMFD
+  std::vector<std::uint32_t> seg_exit_cmfd_;   // Only filled when using CMFD
+  // Quantized segment lengths, for the encoding in use. A segment of FSR i
+  // on a track of angle a has a length of
+  // seg_min_(a, i) + code * seg_scale_(a, i), where the minimum and the scale
+  // include the renormalization of the segment lengths.
+  std::vector<std::uint16_t> seg_codes16_;
+  std::vector<std::uint32_t> seg_codes32_;
+  xt::xtensor<double, 2> seg_min_;
+  xt::xtensor<double, 2> seg_scale_;
+  xt::xtensor<MOCReal, 2> Et_;  // Total (or transport) xs by group then FSR
+  // Total (or transport) xs and source over total xs by FSR then group, for
+  // the group-blocked and one-group sweeps
+  xt::xtensor<MOCReal, 2> Et_by_fsr_;
+  xt::xtensor<double, 2> Q_Et_by_fsr_;
+  // Polar quadrature indexed by the polar index of the sweeps, and padded
+  // with zeros to a multiple of the SIMD batch size.
+  using AlignedVector = std::vector<double, xsimd::aligned_allocator<double>>;
+  using AlignedRealVector =
+      std::vector<MOCReal, xsimd::aligned_allocator<MOCReal>>;
+  AlignedRealVector pq_invs_sin_;
+  AlignedRealVector pq_wsin_;
+  AlignedRealVector pq_wgt_;
+  std::size_t n_pol_pad_{0};
   std::map<std::size_t, std::size_t> fsr_offsets_;  // Indexed by id -> offset
+  // When the FSRs are renumbered, all internal arrays (fsrs_, flux_,
+  // extern_src_, ...) use the internal numbering, while the public interface
+  // keeps using the original one. Both vectors are empty otherwise.
+  std::vector<std::size_t> fsr_internal_indx_;  // Original -> internal
+  std::vector<std::size_t> fsr_original_indx_;  // Internal -> original
   std::size_t ngroups_;
   std::size_t nfsrs_;
   std::size_t n_pol_angles_;
@@ -161,11 +294,142 @@ class MOCDriver {
   std::size_t N_lj_ = 1;      // total number of j (-l ro l)
   bool anisotropic_ = false;  // to account for anisotropic scattering
   SimulationMode mode_{SimulationMode::Keff};
+  ExpEvaluator exp_evaluator_{ExpEvaluator::Rational};
+  ExpTable exp_table_;  // Table of 1 - exp(-x) for ExpEvaluator::Table
+  SweepParallelism sweep_parallelism_{SweepParallelism::Groups};
+  std::size_t group_block_size_{1};  // Groups treated per pass over a track
+  EnergyIteration energy_iteration_{EnergyIteration::Jacobi};
+  std::size_t upscatter_iterations_{1};  // Inner passes over upscatter groups
+  std::size_t first_upscatter_group_{0};  // First group receiving upscatter
+  bool skip_cmfd_tally_{false};  // Set for inner passes not tallying currents
+  TransportSolver transport_solver_{TransportSolver::SourceIteration};
+  std::size_t krylov_restart_{30};  // Krylov subspace size before a restart
+  bool chebyshev_acceleration_{false};  // Extrapolate the outer iterations
+  bool renumber_fsrs_{false};  // Renumber FSRs in the order tracks visit them
+  bool use_tracking_cache_{false};  // Reuse tracks of identical geometries
+  // Lay tracks down cyclically on the tiles. This only speeds up the tracing,
+  // unless the segments are also traced on the fly.
+  bool modular_tracking_{false};
+  bool on_the_fly_tracking_{false};  // Retrace the segments in every sweep
+  SegmentEncoding segment_encoding_{SegmentEncoding::Double};
+  // Boundary angular fluxes of all tracks in a single arena, indexed by
+  // track, direction (entry, exit), group, and polar angle. Tracks refer to
+  // their own blocks, and to those of the tracks they are connected to, by
+  // their offsets in the arena.
+  xt::xtensor<MOCReal, 4> boundary_flux_;
+  // Data for the track parallel sweep. Outgoing angular fluxes are indexed by
+  // track, direction (forward, backward), group, and polar angle.
+  std::vector<Track*> track_list_;
+  std::vector<std::size_t> track_order_;  // Track indices, most segments first
+  ThreadBusyTime sweep_busy_time_;  // Time each thread spent sweeping
+  std::vector<xt::xtensor<double, 3>> thread_flux_;
+  xt::xtensor<MOCReal, 4> track_out_flux_;
+  // Angular source over total xs and angular flux tallies of the group being
+  // swept, shared by all threads in the anisotropic sweep. Indexed by FSR,
+  // azimuthal index, and padded polar index.
+  AlignedRealVector ang_src_;
+  AlignedVector ang_flux_;
+  // Dense scattering matrices (one per Legendre order), fission spectrum and
+  // production of each material, and blocks of FSRs sharing a material, used
+  // to evaluate the sources. Rebuilt at the start of each solve.
+  struct MaterialSource {
+    std::vector<Eigen::MatrixXd> scatter;  // Indexed by out group, in group
+    Eigen::VectorXd chi;
+    Eigen::VectorXd vEf;
+    bool fissile;
+  };
+  struct SourceBlock {
+    std::size_t material;
+    std::vector<std::size_t> fsrs;
+  };
+  std::vector<MaterialSource> material_sources_;
+  std::vector<SourceBlock> source_blocks_;
+  // Per-thread fluxes and sources of a block of FSRs, sized for
+  // SOURCE_BLOCK_SIZE FSRs, and fission source by FSR for the Gauss-Seidel
+  // iteration. Allocated with the material sources, so that the outer
+  // iterations do not allocate.
+  struct SourceWorkspace {
+    Eigen::MatrixXd flux;
+    Eigen::MatrixXd src;
+    Eigen::RowVectorXd fiss;
+  };
+  std::vector<SourceWorkspace> thread_src_work_;
+  std::vector<double> fiss_src_;
   bool solved_{false};
+  bool warm_start_{false};  // Next solve starts from the seeded flux
+  std::size_t iterations_{0};  // Outer iterations of the last solve
 
+  void check_tracking_parameters(std::uint32_t n_angles, double d) const;
+  std::vector<AngleInfo> azimuthal_quadrature(std::uint32_t n_angles,
+                                              double d) const;
   void generate_azimuthal_quadrature(std::uint32_t n_angles, double d);
+
+  // Start point of a track, and length of its chord through the bounding box
+  // of the geometry
+  struct TrackStart {
+    std::size_t angle;
+    std::size_t index;
+    Vector r;
+    double length;
+  };
+  std::vector<TrackStart> track_starts(
+      const std::vector<AngleInfo>& angle_info) const;
   void trace_tracks();
 
+  // Part of a track crossing a single tile, with the FSR instance relative to
+  // the tile. Chords are keyed on the tile contents and the local entry
+  // point, rounded to a multiple of CHORD_TOL. The slot numbers the FSR
+  // instances of each type of tile.
+  struct ChordSegment {
+    const FlatSourceRegion* fsr;
+    std::size_t instance;
+    double length;
+    std::uint32_t slot;
+  };
+  using ChordKey = std::tuple<const void*, long long, long long>;
+  using ChordMap = std::map<ChordKey, std::vector<ChordSegment>>;
+  static constexpr double CHORD_TOL{1.E-8};
+
+  // Chord crossed by a track, in the tile with the flat index j * nx + i
+  struct ChordRef {
+    std::uint32_t tile;
+    const std::vector<ChordSegment>* chord;
+  };
+
+  // Data for on-the-fly tracking. The segment lengths are renormalized by a
+  // factor indexed by angle then FSR, and the chords through the tiles of
+  // each angle are cached for modular tracking. With modular tracking, the
+  // segments are only stored once per type of tile in the chords. Each track
+  // then lists the chords it crosses, starting at its segment offset and
+  // ended by a null chord, and each tile maps the slots of its type to the
+  // original FSR indices. Tracks are retraced in the per-thread segment
+  // buffers.
+  xt::xtensor<double, 2> otf_renorm_;
+  std::vector<ChordMap> otf_chords_;
+  std::vector<ChordRef> otf_chord_refs_;
+  std::vector<std::uint32_t> otf_tile_fsrs_;
+  std::vector<std::size_t> otf_tile_offsets_;
+  double otf_max_length_{0.};  // Bound on the renormalized segment lengths
+  std::vector<std::vector<MOCReal>> thread_seg_lengths_;
+  std::vector<std::vector<std::uint32_t>> thread_seg_fsrs_;
+
+  // Segments of a track, with FSR indices in the internal numbering. Tracks
+  // traced on the fly and quantized lengths use the per-thread buffers.
+  struct TrackSegments {
+    const MOCReal* lengths;
+    const std::uint32_t* fsrs;
+    std::size_t size;
+  };
+  TrackSegments track_segments(const Track& track);
+  void retrace_track(const Track& track, std::vector<MOCReal>& lengths,
+                     std::vector<std::uint32_t>& fsrs) const;
+  void build_chord_cache();
+  void build_chord_refs();
+
+  void trace_track_segments(Vector& r, const Direction& u,
+                            std::vector<Segment>& segments, ChordMap* chords);
+  void set_segment_cmfd_info(Segment& seg, const Vector& r, const Direction& u);
+
   void set_ref_vac_bcs_x_max();
   void set_ref_vac_bcs_x_min();
   void set_ref_vac_bcs_y_max();
@@ -175,53 +439,185 @@ class MOCDriver {
   void set_bcs();
 
   void allocate_fsr_data();
+  void renumber_fsrs_by_tracks();
+  void apply_fsr_order(std::vector<std::size_t> order);
+  std::size_t internal_fsr_indx(std::size_t i) const {
+    return fsr_internal_indx_.empty() ? i : fsr_internal_indx_[i];
+  }
+  std::size_t original_fsr_indx(std::size_t i) const {
+    return fsr_original_indx_.empty() ? i : fsr_original_indx_[i];
+  }
 
   void allocate_track_fluxes();
   void segment_renormalization();
+  void flatten_segments();
+  void build_exp_table();
+  void pad_polar_quadrature();
+  void list_tracks();
+  TrackingKey tracking_key(std::uint32_t n_angles, double d) const;
+  void fill_total_xs();
+  void fill_material_sources();
+
+  // Largest padded number of polar angles which the sweeps can handle
+  static constexpr std::size_t MAX_PADDED_POLAR{16};
+  // Largest number of SIMD batches of polar angles, for which the sweep
+  // kernels are compiled
+  static constexpr std::size_t MAX_POLAR_BATCHES{
+      MAX_PADDED_POLAR / MOCBatch::size};
+  // Largest number of groups in a block of the group-blocked sweep
+  static constexpr std::size_t MAX_GROUP_BLOCK{16};
+  // Largest number of FSRs in a block of the source evaluation
+  static constexpr std::size_t SOURCE_BLOCK_SIZE{64};
+  // Largest number of Krylov iterations for a single linear solve
+  static constexpr std::size_t MAX_KRYLOV_ITERATIONS{1000};
+  // Number of tracks per angle traced to estimate the memory of the tracks
+  static constexpr std::size_t MEMORY_SAMPLE_TRACKS{64};
+
+  static constexpr std::uint32_t NO_CMFD_SURFACE{
+      std::numeric_limits<std::uint32_t>::max()};
+
+  // Initial flux, keff, and boundary angular fluxes of a solve, unless a
+  // matching solution was seeded with set_initial_flux
+  void initialize_solution(std::size_t n_moments, double boundary_flux);
 
   // isotropic
   void solve_isotropic();
   void sweep(xt::xtensor<double, 3>& flux, const xt::xtensor<double, 2>& src);
+  bool sweep_gauss_seidel(xt::xtensor<double, 3>& flux,
+                          xt::xtensor<double, 2>& src,
+                          const xt::xtensor<double, 2>& D,
+                          bool clip_negative_src);
+  // The sweep kernels are compiled for a fixed number NB of SIMD batches of
+  // polar angles, which is selected once per sweep. The segments of the track
+  // are obtained by the caller, so that a track traced on the fly is only
+  // traced once for all of the groups it is swept for.
+  template <std::size_t NB>
+  void sweep_track(Track& track, const TrackSegments& segs, std::size_t g,
+                   xt::xtensor<double, 3>& flux,
+                   const xt::xtensor<double, 2>& src, MOCReal* forw_out,
+                   MOCReal* back_out);
+  template <std::size_t NB>
+  void sweep_track_block(Track& track, const TrackSegments& segs,
+                         std::size_t g0, std::size_t g1,
+                         xt::xtensor<double, 3>& flux, MOCReal* forw_out,
+                         MOCReal* back_out);
+  template <std::size_t NB>
+  void sweep_track_one_group(Track& track, const TrackSegments& segs,
+                             xt::xtensor<double, 3>& flux, MOCReal* forw_out,
+                             MOCReal* back_out);
   void fill_source(xt::xtensor<double, 2>& src,
-                   const xt::xtensor<double, 3>& flux) const;
+                   const xt::xtensor<double, 3>& flux, bool scatter = true,
+                   bool fission = true);
+
+  // Krylov solver for isotropic problems
+  void solve_isotropic_krylov();
+  void pack_krylov_state(const xt::xtensor<double, 3>& flux,
+                         Eigen::Ref<Eigen::VectorXd> x) const;
+  void unpack_krylov_state(const Eigen::Ref<const Eigen::VectorXd>& x,
+                           xt::xtensor<double, 3>& flux);
 
   // anisotropic
   void solve_anisotropic();
   void sweep_anisotropic(xt::xtensor<double, 3>& flux,
                          const xt::xtensor<double, 3>& src);
+  // NLJ is the number of flux moments, or zero to use N_lj_ at run time
+  template <std::size_t NB, std::size_t NLJ>
+  void sweep_anisotropic_impl(xt::xtensor<double, 3>& flux,
+                              const xt::xtensor<double, 3>& src);
+  template <std::size_t NB>
+  void sweep_track_anisotropic(Track& track, const TrackSegments& segs,
+                               std::size_t g, MOCReal* forw_out,
+                               MOCReal* back_out);
+  template <std::size_t NLJ>
+  void fill_angular_source(std::size_t g, const xt::xtensor<double, 3>& src);
+  template <std::size_t NLJ>
+  void project_angular_flux(std::size_t g,
+                            xt::xtensor<double, 3>& flux) const;
   void fill_source_anisotropic(xt::xtensor<double, 3>& src,
-                               const xt::xtensor<double, 3>& flux) const;
+                               const xt::xtensor<double, 3>& flux);
+
+  template <typename TrackSweeper>
+  void sweep_parallel_tracks(xt::xtensor<double, 3>& flux,
+                             std::size_t block_size, TrackSweeper sweep_track,
+                             std::size_t g_begin, std::size_t g_end);
 
   double calc_keff(const xt::xtensor<double, 3>& flux,
                    const xt::xtensor<double, 3>& old_flux) const;
+  double max_flux_diff(xt::xtensor<double, 3>& next_flux,
+                       bool& set_neg_flux_to_zero) const;
+
+  // Boundary angular fluxes of group g for all polar angles, in the block
+  // starting at offset in the arena
+  MOCReal* boundary_flux(std::size_t offset, std::size_t g) {
+    return boundary_flux_.data() + offset + g * n_pol_angles_;
+  }
+  const MOCReal* boundary_flux(std::size_t offset, std::size_t g) const {
+    return boundary_flux_.data() + offset + g * n_pol_angles_;
+  }
+
+  // Number of SIMD batches in the padded polar quadrature
+  std::size_t polar_batches() const {
+    return n_pol_pad_ / MOCBatch::size;
+  }
 
+  friend class CMFD;
   friend class cereal::access;
   MOCDriver() : polar_quad_(YamamotoTabuchi<6>()) {}
   template <class Archive>
   void save(Archive& arc) const {
-    arc(CEREAL_NVP(angle_info_), CEREAL_NVP(tracks_), CEREAL_NVP(geometry_),
+    arc(CEREAL_NVP(angle_info_), CEREAL_NVP(tracks_),
+        CEREAL_NVP(boundary_flux_), CEREAL_NVP(geometry_), CEREAL_NVP(cmfd_),
         CEREAL_NVP(polar_quad_), CEREAL_NVP(sph_harm_), CEREAL_NVP(flux_),
-        CEREAL_NVP(extern_src_), CEREAL_NVP(ngroups_), CEREAL_NVP(nfsrs_),
-        CEREAL_NVP(n_pol_angles_), CEREAL_NVP(flux_tol_), CEREAL_NVP(keff_tol_),
-        CEREAL_NVP(keff_), CEREAL_NVP(x_min_bc_), CEREAL_NVP(x_max_bc_),
-        CEREAL_NVP(y_min_bc_), CEREAL_NVP(y_max_bc_), CEREAL_NVP(max_L_),
-        CEREAL_NVP(N_lj_), CEREAL_NVP(anisotropic_), CEREAL_NVP(mode_),
-        CEREAL_NVP(solved_));
+        CEREAL_NVP(extern_src_), CEREAL_NVP(seg_lengths_),
+        CEREAL_NVP(seg_fsrs_), CEREAL_NVP(seg_entry_cmfd_),
+        CEREAL_NVP(seg_exit_cmfd_), CEREAL_NVP(seg_codes16_),
+        CEREAL_NVP(seg_codes32_), CEREAL_NVP(seg_min_), CEREAL_NVP(seg_scale_),
+        CEREAL_NVP(ngroups_),
+        CEREAL_NVP(nfsrs_), CEREAL_NVP(n_pol_angles_), CEREAL_NVP(flux_tol_),
+        CEREAL_NVP(keff_tol_), CEREAL_NVP(keff_), CEREAL_NVP(x_min_bc_),
+        CEREAL_NVP(x_max_bc_), CEREAL_NVP(y_min_bc_), CEREAL_NVP(y_max_bc_),
+        CEREAL_NVP(max_L_), CEREAL_NVP(N_lj_), CEREAL_NVP(anisotropic_),
+        CEREAL_NVP(mode_), CEREAL_NVP(exp_evaluator_), CEREAL_NVP(exp_table_),
+        CEREAL_NVP(sweep_parallelism_), CEREAL_NVP(group_block_size_),
+        CEREAL_NVP(energy_iteration_), CEREAL_NVP(upscatter_iterations_),
+        CEREAL_NVP(transport_solver_), CEREAL_NVP(krylov_restart_),
+        CEREAL_NVP(chebyshev_acceleration_), CEREAL_NVP(renumber_fsrs_),
+        CEREAL_NVP(use_tracking_cache_), CEREAL_NVP(modular_tracking_),
+        CEREAL_NVP(on_the_fly_tracking_), CEREAL_NVP(segment_encoding_),
+        CEREAL_NVP(otf_renorm_), CEREAL_NVP(fsr_internal_indx_),
+        CEREAL_NVP(fsr_original_indx_), CEREAL_NVP(solved_));
   }
 
   template <class Archive>
   void load(Archive& arc) {
-    arc(CEREAL_NVP(angle_info_), CEREAL_NVP(tracks_), CEREAL_NVP(geometry_),
+    arc(CEREAL_NVP(angle_info_), CEREAL_NVP(tracks_),
+        CEREAL_NVP(boundary_flux_), CEREAL_NVP(geometry_), CEREAL_NVP(cmfd_),
         CEREAL_NVP(polar_quad_), CEREAL_NVP(sph_harm_), CEREAL_NVP(flux_),
-        CEREAL_NVP(extern_src_), CEREAL_NVP(ngroups_), CEREAL_NVP(nfsrs_),
-        CEREAL_NVP(n_pol_angles_), CEREAL_NVP(flux_tol_), CEREAL_NVP(keff_tol_),
-        CEREAL_NVP(keff_), CEREAL_NVP(x_min_bc_), CEREAL_NVP(x_max_bc_),
-        CEREAL_NVP(y_min_bc_), CEREAL_NVP(y_max_bc_), CEREAL_NVP(max_L_),
-        CEREAL_NVP(N_lj_), CEREAL_NVP(anisotropic_), CEREAL_NVP(mode_),
-        CEREAL_NVP(solved_));
-    // Need to reset internal pointers
+        CEREAL_NVP(extern_src_), CEREAL_NVP(seg_lengths_),
+        CEREAL_NVP(seg_fsrs_), CEREAL_NVP(seg_entry_cmfd_),
+        CEREAL_NVP(seg_exit_cmfd_), CEREAL_NVP(seg_codes16_),
+        CEREAL_NVP(seg_codes32_), CEREAL_NVP(seg_min_), CEREAL_NVP(seg_scale_),
+        CEREAL_NVP(ngroups_),
+        CEREAL_NVP(nfsrs_), CEREAL_NVP(n_pol_angles_), CEREAL_NVP(flux_tol_),
+        CEREAL_NVP(keff_tol_), CEREAL_NVP(keff_), CEREAL_NVP(x_min_bc_),
+        CEREAL_NVP(x_max_bc_), CEREAL_NVP(y_min_bc_), CEREAL_NVP(y_max_bc_),
+        CEREAL_NVP(max_L_), CEREAL_NVP(N_lj_), CEREAL_NVP(anisotropic_),
+        CEREAL_NVP(mode_), CEREAL_NVP(exp_evaluator_), CEREAL_NVP(exp_table_),
+        CEREAL_NVP(sweep_parallelism_), CEREAL_NVP(group_block_size_),
+        CEREAL_NVP(energy_iteration_), CEREAL_NVP(upscatter_iterations_),
+        CEREAL_NVP(transport_solver_), CEREAL_NVP(krylov_restart_),
+        CEREAL_NVP(chebyshev_acceleration_), CEREAL_NVP(renumber_fsrs_),
+        CEREAL_NVP(use_tracking_cache_), CEREAL_NVP(modular_tracking_),
+        CEREAL_NVP(on_the_fly_tracking_), CEREAL_NVP(segment_encoding_),
+        CEREAL_NVP(otf_renorm_), CEREAL_NVP(fsr_internal_indx_),
+        CEREAL_NVP(fsr_original_indx_), CEREAL_NVP(solved_));
+    // Need to reset internal pointers. The track connections are offsets in
+    // the boundary flux arena, and are restored with the tracks.
     this->allocate_fsr_data();
-    this->set_bcs();
+    this->pad_polar_quadrature();
+    this->list_tracks();
+    // The cached chords point to the geometry, and are traced again
+    if (on_the_fly_tracking_) this->build_chord_cache();
   }
 };
 
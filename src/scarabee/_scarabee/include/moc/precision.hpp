@@ -0,0 +1,20 @@
+#ifndef MOC_PRECISION_H
+#define MOC_PRECISION_H
+
+namespace scarabee {
+
+// Floating point type used to store the boundary angular fluxes, segment
+// lengths, and total cross sections of the MOC sweeps, and of the SIMD
+// attenuation of the angular flux along the segments. The scalar flux
+// tallies, sources, and keff reductions always use double. Compiling with
+// SCARABEE_MIXED_PRECISION uses single precision, halving the memory traffic
+// of the sweep and doubling the number of polar angles in a SIMD batch.
+#ifdef SCARABEE_MIXED_PRECISION
+using MOCReal = float;
+#else
+using MOCReal = double;
+#endif
+
+}  // namespace scarabee
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef SEGMENT_ENCODING_H
+#define SEGMENT_ENCODING_H
+
+#include <cstdint>
+
+namespace scarabee {
+
+// Storage of the segment lengths of the MOC tracks. Double stores the lengths
+// as MOCReal, while the quantized encodings store each length as the minimum
+// length in its FSR plus an integer multiple of a step set for each FSR.
+enum class SegmentEncoding : std::uint8_t { Double, Quantized32, Quantized16 };
+
+}
+
+#endif
@@ -21,6 +21,12 @@ class SimplePinCell : public Cell {
                 const std::vector<std::shared_ptr<CrossSection>>& mats,
                 double dx, double dy, PinCellType pin_type = PinCellType::Full);
 
+  const std::vector<double>& radii() const { return mat_radii_; }
+  const std::vector<std::shared_ptr<CrossSection>>& materials() const {
+    return mats_;
+  }
+  PinCellType pin_type() const { return pin_type_; }
+
  private:
   std::vector<double> mat_radii_;
   std::vector<std::shared_ptr<CrossSection>> mats_;
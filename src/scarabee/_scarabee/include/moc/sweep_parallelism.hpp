@@ -0,0 +1,13 @@
+#ifndef SWEEP_PARALLELISM_H
+#define SWEEP_PARALLELISM_H
+
+#include <cstdint>
+
+namespace scarabee {
+
+// Work distributed over the threads in the MOC sweep
+enum class SweepParallelism : std::uint8_t { Groups, Tracks };
+
+}
+
+#endif
@@ -8,8 +8,6 @@
 #include <utils/constants.hpp>
 #include <utils/serialization.hpp>
 
-#include <xtensor/xtensor.hpp>
-
 #include <cereal/cereal.hpp>
 #include <cereal/types/vector.hpp>
 
@@ -44,20 +42,47 @@ class Track {
   BoundaryCondition& exit_bc() { return exit_bc_; }
   const BoundaryCondition& exit_bc() const { return exit_bc_; }
 
-  xt::xtensor<double, 2>& entry_flux() { return entry_flux_; }
-  const xt::xtensor<double, 2>& entry_flux() const { return entry_flux_; }
+  // Boundary angular fluxes are stored in a single arena of the MOCDriver,
+  // and are referred to by their offset in the arena. Each block of fluxes
+  // is indexed by group and polar angle. The entry flux is incident at the
+  // entry of the track (forward sweep), and the exit flux is incident at the
+  // exit of the track (backward sweep).
+  std::size_t entry_flux_offset() const { return entry_flux_offset_; }
+  std::size_t exit_flux_offset() const { return exit_flux_offset_; }
+  void set_flux_offsets(std::size_t entry, std::size_t exit) {
+    entry_flux_offset_ = entry;
+    exit_flux_offset_ = exit;
+  }
 
-  xt::xtensor<double, 2>& exit_flux() { return exit_flux_; }
-  const xt::xtensor<double, 2>& exit_flux() const { return exit_flux_; }
+  // Offsets of the boundary fluxes of the connected tracks, which receive the
+  // outgoing angular flux of the backward (entry) and forward (exit) sweeps
+  std::size_t entry_track_flux_offset() const {
+    return entry_track_flux_offset_;
+  }
+  void set_entry_track_flux_offset(std::size_t offset) {
+    entry_track_flux_offset_ = offset;
+  }
 
-  xt::xtensor<double, 2>& entry_track_flux() { return *entry_track_flux_; }
-  void set_entry_track_flux(xt::xtensor<double, 2>* etf) {
-    entry_track_flux_ = etf;
+  std::size_t exit_track_flux_offset() const {
+    return exit_track_flux_offset_;
+  }
+  void set_exit_track_flux_offset(std::size_t offset) {
+    exit_track_flux_offset_ = offset;
   }
 
-  xt::xtensor<double, 2>& exit_track_flux() { return *exit_track_flux_; }
-  void set_exit_track_flux(xt::xtensor<double, 2>* etf) {
-    exit_track_flux_ = etf;
+  // Position and number of segments in the flattened segment arrays of the
+  // MOCDriver. The Segment objects are only kept until the tracks have been
+  // flattened, after which the segments() vector is empty. With on-the-fly
+  // tracking, the segments are never stored, and the offset is that of the
+  // chords crossed by the track when the laydown is modular.
+  std::size_t segment_offset() const { return segment_offset_; }
+  std::size_t num_segments() const { return num_segments_; }
+  void set_segment_offset(std::size_t offset) { segment_offset_ = offset; }
+  void set_flattened(std::size_t offset) {
+    segment_offset_ = offset;
+    num_segments_ = segments_.size();
+    segments_.clear();
+    segments_.shrink_to_fit();
   }
 
   // Indexing is only done in forward direction
@@ -93,14 +118,16 @@ class Track {
   const_reverse_iterator crend() const { return segments_.crend(); }
 
  private:
-  xt::xtensor<double, 2> entry_flux_;  // Indexed on group and polar angle
-  xt::xtensor<double, 2> exit_flux_;
   std::vector<Segment> segments_;
+  std::size_t segment_offset_{0};
+  std::size_t num_segments_{0};
   Vector entry_;
   Vector exit_;
   Direction dir_;
-  xt::xtensor<double, 2>* entry_track_flux_;
-  xt::xtensor<double, 2>* exit_track_flux_;
+  std::size_t entry_flux_offset_{0};
+  std::size_t exit_flux_offset_{0};
+  std::size_t entry_track_flux_offset_{0};
+  std::size_t exit_track_flux_offset_{0};
   double wgt_;    // Track weight
   double width_;  // Track width
   double phi_;    // Azimuthal angle of Track
@@ -113,11 +140,14 @@ class Track {
   friend class cereal::access;
   template <class Archive>
   void serialize(Archive& arc) {
-    arc(CEREAL_NVP(entry_flux_), CEREAL_NVP(exit_flux_), CEREAL_NVP(segments_),
-        CEREAL_NVP(entry_), CEREAL_NVP(exit_), CEREAL_NVP(dir_),
-        CEREAL_NVP(wgt_), CEREAL_NVP(width_), CEREAL_NVP(phi_),
-        CEREAL_NVP(entry_bc_), CEREAL_NVP(exit_bc_),
-        CEREAL_NVP(forward_phi_index_), CEREAL_NVP(backward_phi_index_));
+    arc(CEREAL_NVP(segments_), CEREAL_NVP(segment_offset_),
+        CEREAL_NVP(num_segments_), CEREAL_NVP(entry_), CEREAL_NVP(exit_),
+        CEREAL_NVP(dir_), CEREAL_NVP(entry_flux_offset_),
+        CEREAL_NVP(exit_flux_offset_), CEREAL_NVP(entry_track_flux_offset_),
+        CEREAL_NVP(exit_track_flux_offset_), CEREAL_NVP(wgt_),
+        CEREAL_NVP(width_), CEREAL_NVP(phi_), CEREAL_NVP(entry_bc_),
+        CEREAL_NVP(exit_bc_), CEREAL_NVP(forward_phi_index_),
+        CEREAL_NVP(backward_phi_index_));
   }
 };
 
@@ -0,0 +1,84 @@
+#ifndef TRACKING_CACHE_H
+#define TRACKING_CACHE_H
+
+#include <moc/precision.hpp>
+#include <moc/segment_encoding.hpp>
+#include <moc/track.hpp>
+
+#include <xtensor/xtensor.hpp>
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace scarabee {
+
+// Tracks and flattened segment data of a traced geometry. The FSR indices
+// use the original numbering of the MOCDriver. Only the lengths of the
+// segment encoding used by the MOCDriver are filled.
+struct TrackLaydown {
+  std::vector<std::vector<Track>> tracks;
+  std::vector<MOCReal> seg_lengths;
+  std::vector<std::uint16_t> seg_codes16;
+  std::vector<std::uint32_t> seg_codes32;
+  xt::xtensor<double, 2> seg_min;
+  xt::xtensor<double, 2> seg_scale;
+  std::vector<std::uint32_t> seg_fsrs;
+  std::size_t nfsrs;
+
+  // Approximate number of bytes held by the laydown
+  std::size_t memory() const;
+};
+
+// Everything which determines the tracks of a geometry. The geometry is
+// given by Cartesian2D::geometry_layout, so problems which only differ by
+// their materials have the same key.
+struct TrackingKey {
+  std::vector<double> geometry;
+  std::uint32_t n_angles;
+  double d;
+  bool modular;
+  SegmentEncoding encoding;
+
+  auto operator<=>(const TrackingKey&) const = default;
+  bool operator==(const TrackingKey&) const = default;
+};
+
+// Process wide cache of track laydowns. The laydowns are evicted from the
+// least recently used, once the memory held by the cache goes above
+// max_memory. A laydown which is larger than max_memory is not cached.
+class TrackingCache {
+ public:
+  static std::shared_ptr<const TrackLaydown> get(const TrackingKey& key);
+  static void insert(const TrackingKey& key,
+                     std::shared_ptr<const TrackLaydown> laydown);
+  static void clear();
+  static std::size_t size();
+  static std::size_t memory();
+
+  static std::size_t max_memory();
+  static void set_max_memory(std::size_t max_memory);
+
+ private:
+  struct Entry {
+    std::shared_ptr<const TrackLaydown> laydown;
+    std::size_t memory;
+    std::uint64_t last_use;
+  };
+
+  static std::map<TrackingKey, Entry> cache_;
+  static std::size_t memory_;
+  static std::size_t max_memory_;
+  static std::uint64_t use_counter_;
+  static std::mutex mutex_;
+
+  static void evict(std::size_t max_memory);
+};
+
+}  // namespace scarabee
+
+#endif
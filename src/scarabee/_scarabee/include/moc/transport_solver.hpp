@@ -0,0 +1,13 @@
+#ifndef TRANSPORT_SOLVER_H
+#define TRANSPORT_SOLVER_H
+
+#include <cstdint>
+
+namespace scarabee {
+
+// Method used to converge the scattering source of the MOC solver
+enum class TransportSolver : std::uint8_t { SourceIteration, GMRES };
+
+}
+
+#endif
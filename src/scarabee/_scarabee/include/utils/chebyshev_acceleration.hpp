@@ -0,0 +1,108 @@
+#ifndef SCARABEE_CHEBYSHEV_ACCELERATION_H
+#define SCARABEE_CHEBYSHEV_ACCELERATION_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace scarabee {
+
+// Chebyshev extrapolation of a power iteration x_{n+1} = T(x_n). A few free
+// iterations estimate the dominance ratio rho from the ratio of successive
+// residual norms. Cycles of extrapolated iterations then follow, with
+//
+//   x_{p+1} = x_p + a_p (T(x_p) - x_p) + b_p (x_p - x_{p-1}),
+//
+// where a_p and b_p come from the Chebyshev polynomials on [0, rho]. A cycle
+// is abandoned, and rho estimated again, if the residual grows.
+class ChebyshevAcceleration {
+ public:
+  ChebyshevAcceleration(std::size_t free_iterations = 3,
+                        std::size_t cycle_length = 10);
+
+  // Given the input x_old of the last application of T, replaces its output
+  // x_new with the extrapolated iterate.
+  void extrapolate(std::span<const double> x_old, std::span<double> x_new) {
+    this->extrapolate(x_old, x_new, std::span<const double>(),
+                      std::span<double>());
+  }
+
+  // Same, for an iterate split into two blocks x and y, which are
+  // extrapolated with the same coefficients. The second block may be stored
+  // in another floating point type.
+  template <typename T>
+  void extrapolate(std::span<const double> x_old, std::span<double> x_new,
+                   std::span<const T> y_old, std::span<T> y_new) {
+    const double res =
+        std::sqrt(squared_residual<double>(x_old, x_new) +
+                  squared_residual<T>(y_old, y_new));
+
+    if (this->begin_step(res) == false) {
+      x_prev_.resize(x_old.size() + y_old.size());
+      std::copy(x_old.begin(), x_old.end(), x_prev_.begin());
+      std::copy(y_old.begin(), y_old.end(), x_prev_.begin() + x_old.size());
+      return;
+    }
+
+    this->combine<double>(x_old, x_new, 0);
+    this->combine<T>(y_old, y_new, x_old.size());
+    this->end_step();
+  }
+
+  void reset();
+
+  double dominance_ratio() const { return rho_; }
+  bool extrapolating() const { return p_ > 0; }
+
+ private:
+  std::vector<double> x_prev_;  // Input of the previous iteration
+  std::size_t free_iterations_;
+  std::size_t cycle_length_;
+  std::size_t n_free_{0};  // Free iterations since the end of the last cycle
+  std::size_t p_{0};       // Index in the current cycle, 0 when not in one
+  double prev_res_{0.};    // Residual of the previous free iteration
+  double cycle_res_{0.};   // Residual at the start of the current cycle
+  double rho_{0.};         // Estimated dominance ratio
+  double gamma_{0.};       // acosh(2 / rho - 1)
+
+  double a_{0.};           // Coefficients of the current step
+  double b_{0.};
+
+  // Extrapolation is not worth it for fast converging iterations
+  static constexpr double MIN_DOMINANCE_RATIO{0.5};
+
+  // Updates the state with the residual of the last iteration. Returns true
+  // if the iterate must be extrapolated, with the coefficients a_ and b_.
+  bool begin_step(double res);
+  void end_step();
+
+  template <typename T>
+  static double squared_residual(std::span<const T> x_old,
+                                 std::span<const T> x_new) {
+    double res = 0.;
+    for (std::size_t i = 0; i < x_new.size(); i++) {
+      const double r =
+          static_cast<double>(x_new[i]) - static_cast<double>(x_old[i]);
+      res += r * r;
+    }
+    return res;
+  }
+
+  template <typename T>
+  void combine(std::span<const T> x_old, std::span<T> x_new,
+               std::size_t offset) {
+    for (std::size_t i = 0; i < x_new.size(); i++) {
+      const double xo = static_cast<double>(x_old[i]);
+      const double xn = static_cast<double>(x_new[i]);
+      const double x = xo + a_ * (xn - xo) + b_ * (xo - x_prev_[offset + i]);
+      x_prev_[offset + i] = xo;
+      x_new[i] = static_cast<T>(x);
+    }
+  }
+};
+
+}  // namespace scarabee
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef SCARABEE_GMRES_H
+#define SCARABEE_GMRES_H
+
+#include <Eigen/Dense>
+
+#include <cstddef>
+#include <functional>
+
+namespace scarabee {
+
+struct GMRESResult {
+  std::size_t iterations;             // Number of Krylov iterations
+  std::size_t operator_applications;  // Number of calls to the operator
+  double residual;                    // Final relative residual
+  bool converged;
+};
+
+// Operator of a linear system, computing y = A x
+using LinearOperator = std::function<void(
+    const Eigen::Ref<const Eigen::VectorXd>& x, Eigen::Ref<Eigen::VectorXd> y)>;
+
+// Restarted GMRES solver for systems A x = b of a given size. The Krylov
+// basis holds restart + 1 vectors of the size of the system. It is allocated
+// with the other work arrays on construction, and reused by every solve.
+class GMRES {
+ public:
+  GMRES(std::size_t size, std::size_t restart);
+
+  // Solves A x = b, starting from the initial guess in x. Iterations stop once
+  // the residual relative to the norm of b is below tol, or after max_iters
+  // iterations.
+  GMRESResult solve(const LinearOperator& A, const Eigen::VectorXd& b,
+                    Eigen::VectorXd& x, std::size_t max_iters, double tol);
+
+  std::size_t size() const { return static_cast<std::size_t>(w_.size()); }
+  std::size_t restart() const { return static_cast<std::size_t>(H_.cols()); }
+
+  // Memory used by the Krylov basis and the work arrays, in bytes
+  std::size_t memory() const;
+
+ private:
+  Eigen::MatrixXd V_;  // Orthonormal basis of the Krylov subspace
+  Eigen::MatrixXd H_;  // Hessenberg matrix, reduced by rotations
+  Eigen::VectorXd cs_, sn_;  // Givens rotations
+  Eigen::VectorXd g_;        // Rotated residual
+  Eigen::VectorXd y_;        // Solution of the least squares problem
+  Eigen::VectorXd w_;
+};
+
+}  // namespace scarabee
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef SCARABEE_HASH_H
+#define SCARABEE_HASH_H
+
+#include <cstddef>
+#include <functional>
+
+namespace scarabee {
+
+// Mixes the hash of v into seed, as done by boost::hash_combine
+template <typename T>
+inline void hash_combine(std::size_t& seed, const T& v) {
+  seed ^= std::hash<T>{}(v) + 0x9e3779b97f4a7c15ULL + (seed << 6) +
+          (seed >> 2);
+}
+
+}  // namespace scarabee
+
+#endif
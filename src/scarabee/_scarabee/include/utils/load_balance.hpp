@@ -0,0 +1,41 @@
+#ifndef SCARABEE_LOAD_BALANCE_H
+#define SCARABEE_LOAD_BALANCE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace scarabee {
+
+// Indices of the work items sorted by decreasing cost. Handing the most
+// expensive items out first in a dynamic OpenMP loop leaves the cheap ones
+// to fill in the gaps at the end, which keeps the threads balanced.
+std::vector<std::size_t> longest_first_order(const std::vector<double>& costs);
+
+// Time spent by each thread working in parallel loops. Each thread only adds
+// to its own entry, so no synchronization is needed within a parallel region.
+class ThreadBusyTime {
+ public:
+  ThreadBusyTime() = default;
+
+  // Clears the times, sized for the maximum number of threads
+  void reset();
+
+  // Must be called from within a parallel region
+  void add(double seconds);
+
+  const std::vector<double>& times() const { return times_; }
+
+  // Ratio of the largest busy time to the mean. A value of 1 indicates a
+  // perfectly balanced workload.
+  double imbalance() const;
+
+  void log(const std::string& label) const;
+
+ private:
+  std::vector<double> times_;
+};
+
+}  // namespace scarabee
+
+#endif
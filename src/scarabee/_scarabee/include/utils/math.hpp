@@ -5,29 +5,31 @@ namespace scarabee {
 
 double exp(double x);
 
-// Evaluates 1 - exp(-x)
-inline double mexp(double x) {
+// Evaluates 1 - exp(-x). This is a template so that it may also be used
+// with SIMD batches, in which case S is the type of the batch elements.
+template <typename T, typename S = double>
+inline T mexp(T x) {
   // This function was taken from OpenMOC : expF1_fractional
   // Originally generated by Colin Josey with Remez's algorithm.
 
   // Coefficients for numerator
-  constexpr double p0 = 1.0;
-  constexpr double p1 = 2.4172687328033081 * 1E-1;
-  constexpr double p2 = 6.2804790965268531 * 1E-2;
-  constexpr double p3 = 1.0567595009016521 * 1E-2;
-  constexpr double p4 = 1.0059468082903561 * 1E-3;
-  constexpr double p5 = 1.9309063097411041 * 1E-4;
+  constexpr S p0 = static_cast<S>(1.0);
+  constexpr S p1 = static_cast<S>(2.4172687328033081 * 1E-1);
+  constexpr S p2 = static_cast<S>(6.2804790965268531 * 1E-2);
+  constexpr S p3 = static_cast<S>(1.0567595009016521 * 1E-2);
+  constexpr S p4 = static_cast<S>(1.0059468082903561 * 1E-3);
+  constexpr S p5 = static_cast<S>(1.9309063097411041 * 1E-4);
 
   // Coefficients for denominator
-  constexpr double d0 = 1.0;
-  constexpr double d1 = 7.4169266112320541 * 1E-1;
-  constexpr double d2 = 2.6722515319494311 * 1E-1;
-  constexpr double d3 = 6.1643725066901411 * 1E-2;
-  constexpr double d4 = 1.0590759992367811 * 1E-2;
-  constexpr double d5 = 1.0057980007137651 * 1E-3;
-  constexpr double d6 = 1.9309063097411041 * 1E-4;
+  constexpr S d0 = static_cast<S>(1.0);
+  constexpr S d1 = static_cast<S>(7.4169266112320541 * 1E-1);
+  constexpr S d2 = static_cast<S>(2.6722515319494311 * 1E-1);
+  constexpr S d3 = static_cast<S>(6.1643725066901411 * 1E-2);
+  constexpr S d4 = static_cast<S>(1.0590759992367811 * 1E-2);
+  constexpr S d5 = static_cast<S>(1.0057980007137651 * 1E-3);
+  constexpr S d6 = static_cast<S>(1.9309063097411041 * 1E-4);
 
-  double num, den;
+  T num, den;
 
   den = d6 * x + d5;
   den = den * x + d4;
@@ -35,7 +37,7 @@ inline double mexp(double x) {
   den = den * x + d2;
   den = den * x + d1;
   den = den * x + d0;
-  den = 1.f / den;
+  den = T(d0) / den;
 
   num = p5 * x + p4;
   num = num * x + p3;
@@ -0,0 +1,32 @@
+#ifndef SCARABEE_THREADS_H
+#define SCARABEE_THREADS_H
+
+#ifdef SCARABEE_USE_OMP
+#include <omp.h>
+#endif
+
+#include <cstddef>
+
+namespace scarabee {
+
+// Maximum number of threads which may be used in a parallel region
+inline std::size_t max_threads() {
+#ifdef SCARABEE_USE_OMP
+  return static_cast<std::size_t>(omp_get_max_threads());
+#else
+  return 1;
+#endif
+}
+
+// Index of the calling thread in the current parallel region
+inline std::size_t thread_num() {
+#ifdef SCARABEE_USE_OMP
+  return static_cast<std::size_t>(omp_get_thread_num());
+#else
+  return 0;
+#endif
+}
+
+}  // namespace scarabee
+
+#endif
@@ -0,0 +1,46 @@
+#include <utils/load_balance.hpp>
+#include <utils/logging.hpp>
+#include <utils/threads.hpp>
+
+#include <algorithm>
+#include <numeric>
+
+namespace scarabee {
+
+std::vector<std::size_t> longest_first_order(const std::vector<double>& costs) {
+  std::vector<std::size_t> order(costs.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&costs](std::size_t a, std::size_t b) {
+                     return costs[a] > costs[b];
+                   });
+  return order;
+}
+
+void ThreadBusyTime::reset() { times_.assign(max_threads(), 0.); }
+
+void ThreadBusyTime::add(double seconds) {
+  const std::size_t t = thread_num();
+  if (t < times_.size()) times_[t] += seconds;
+}
+
+double ThreadBusyTime::imbalance() const {
+  if (times_.empty()) return 1.;
+
+  const double total = std::accumulate(times_.begin(), times_.end(), 0.);
+  if (total <= 0.) return 1.;
+
+  const double mean = total / static_cast<double>(times_.size());
+  return *std::max_element(times_.begin(), times_.end()) / mean;
+}
+
+void ThreadBusyTime::log(const std::string& label) const {
+  if (times_.size() < 2) return;
+
+  const auto [min, max] = std::minmax_element(times_.begin(), times_.end());
+  spdlog::info("{} thread busy time: min {:.5E} s, max {:.5E} s", label, *min,
+               *max);
+  spdlog::info("{} load imbalance (max / mean): {:.3f}", label, imbalance());
+}
+
+}  // namespace scarabee
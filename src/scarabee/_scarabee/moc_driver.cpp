@@ -4,15 +4,22 @@
 #include <utils/logging.hpp>
 #include <utils/timer.hpp>
 #include <utils/math.hpp>
+#include <utils/threads.hpp>
+#include <utils/gmres.hpp>
+#include <utils/chebyshev_acceleration.hpp>
 
 #include <xtensor/xmath.hpp>
 #include <xtensor/xview.hpp>
 
 #include <cereal/archives/portable_binary.hpp>
 
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <filesystem>
 #include <fstream>
+#include <type_traits>
+#include <utility>
 
 namespace scarabee {
 
@@ -87,6 +94,36 @@ void MOCDriver::set_flux_tolerance(double ftol) {
   flux_tol_ = ftol;
 }
 
+void MOCDriver::set_group_block_size(std::size_t block_size) {
+  if (block_size == 0 || block_size > MAX_GROUP_BLOCK) {
+    auto mssg = "Group block size must be in the interval [1, 16].";
+    spdlog::error(mssg);
+    throw ScarabeeException(mssg);
+  }
+
+  group_block_size_ = block_size;
+}
+
+void MOCDriver::set_upscatter_iterations(std::size_t iterations) {
+  if (iterations == 0) {
+    auto mssg = "Number of upscatter iterations must be at least 1.";
+    spdlog::error(mssg);
+    throw ScarabeeException(mssg);
+  }
+
+  upscatter_iterations_ = iterations;
+}
+
+void MOCDriver::set_krylov_restart(std::size_t restart) {
+  if (restart == 0) {
+    auto mssg = "Krylov restart must be at least 1.";
+    spdlog::error(mssg);
+    throw ScarabeeException(mssg);
+  }
+
+  krylov_restart_ = restart;
+}
+
 void MOCDriver::set_keff_tolerance(double ktol) {
   if (ktol <= 0.) {
     auto mssg = "Tolerance for keff must be in the interval (0., 0.1).";
@@ -103,6 +140,55 @@ void MOCDriver::set_keff_tolerance(double ktol) {
   keff_tol_ = ktol;
 }
 
+void MOCDriver::set_cmfd(std::shared_ptr<CMFD> cmfd) {
+  if (cmfd) {
+    if (this->drawn()) {
+      auto mssg = "CMFD must be set before tracks are generated.";
+      spdlog::error(mssg);
+      throw ScarabeeException(mssg);
+    }
+
+    if (cmfd->nmoc_groups() != ngroups_) {
+      auto mssg =
+          "The CMFD group condensation scheme does not match the number of "
+          "groups in the MOC problem.";
+      spdlog::error(mssg);
+      throw ScarabeeException(mssg);
+    }
+
+    if (std::abs(cmfd->x_min() - this->x_min()) > 1.E-8 ||
+        std::abs(cmfd->x_max() - this->x_max()) > 1.E-8 ||
+        std::abs(cmfd->y_min() - this->y_min()) > 1.E-8 ||
+        std::abs(cmfd->y_max() - this->y_max()) > 1.E-8) {
+      auto mssg = "The CMFD mesh does not cover the MOC geometry.";
+      spdlog::error(mssg);
+      throw ScarabeeException(mssg);
+    }
+  }
+
+  cmfd_ = cmfd;
+}
+
+void MOCDriver::set_on_the_fly_tracking(bool on_the_fly) {
+  if (this->drawn() && on_the_fly != on_the_fly_tracking_) {
+    auto mssg = "On-the-fly tracking must be set before tracks are generated.";
+    spdlog::error(mssg);
+    throw ScarabeeException(mssg);
+  }
+
+  on_the_fly_tracking_ = on_the_fly;
+}
+
+void MOCDriver::set_segment_encoding(SegmentEncoding encoding) {
+  if (this->drawn() && encoding != segment_encoding_) {
+    auto mssg = "The segment encoding must be set before tracks are generated.";
+    spdlog::error(mssg);
+    throw ScarabeeException(mssg);
+  }
+
+  segment_encoding_ = encoding;
+}
+
 void MOCDriver::generate_tracks(std::uint32_t n_angles, double d,
                                 PolarQuadrature polar_quad) {
   // Timer for method
@@ -118,23 +204,13 @@ void MOCDriver::generate_tracks(std::uint32_t n_angles, double d,
   if (anisotropic_ == true) {
     n_pol_angles_ *= 2;
   }
+  pad_polar_quadrature();
 
-  if (n_angles < 4) {
-    auto mssg = "MOCDriver must have at least 4 angles.";
-    spdlog::error(mssg);
-    throw ScarabeeException(mssg);
-  }
-
-  if (n_angles % 4 != 0) {
-    // If the number of angles isn't a multiple of 4, we won't be able to make
-    // all the boundary condition connections due to an odd number.
-    auto mssg = "MOCDriver number of angles must be a multiple of 4.";
-    spdlog::error(mssg);
-    throw ScarabeeException(mssg);
-  }
+  check_tracking_parameters(n_angles, d);
 
-  if (d <= 0.) {
-    auto mssg = "MOCDriver track spacing must be > 0.";
+  if (on_the_fly_tracking_ && cmfd_) {
+    // The CMFD surfaces crossed by the segments are only known when tracing
+    auto mssg = "On-the-fly tracking cannot be used with CMFD.";
     spdlog::error(mssg);
     throw ScarabeeException(mssg);
   }
@@ -144,8 +220,33 @@ void MOCDriver::generate_tracks(std::uint32_t n_angles, double d,
   tracks_.clear();
 
   generate_azimuthal_quadrature(n_angles, d);
-  trace_tracks();
-  segment_renormalization();
+
+  // Tracks are only cached without CMFD, as the CMFD FSR lists and surface
+  // indices are built while tracing. Segments traced on the fly are never
+  // stored.
+  const bool use_cache =
+      use_tracking_cache_ && cmfd_ == nullptr && on_the_fly_tracking_ == false;
+  const TrackingKey cache_key =
+      use_cache ? tracking_key(n_angles, d) : TrackingKey{};
+  std::shared_ptr<const TrackLaydown> laydown =
+      use_cache ? TrackingCache::get(cache_key) : nullptr;
+  if (laydown && laydown->nfsrs != nfsrs_) laydown = nullptr;
+
+  if (laydown) {
+    spdlog::info("Reusing tracks from the tracking cache");
+    tracks_ = laydown->tracks;
+    seg_lengths_ = laydown->seg_lengths;
+    seg_codes16_ = laydown->seg_codes16;
+    seg_codes32_ = laydown->seg_codes32;
+    seg_min_ = laydown->seg_min;
+    seg_scale_ = laydown->seg_scale;
+    seg_fsrs_ = laydown->seg_fsrs;
+    seg_entry_cmfd_.clear();
+    seg_exit_cmfd_.clear();
+  } else {
+    trace_tracks();
+    segment_renormalization();
+  }
 
   if ((x_min_bc_ == BoundaryCondition::Periodic &&
        x_max_bc_ != BoundaryCondition::Periodic) ||
@@ -165,15 +266,282 @@ void MOCDriver::generate_tracks(std::uint32_t n_angles, double d,
     throw ScarabeeException(mssg);
   }
 
-  spdlog::info("Determining track connections");
-  set_bcs();
+  if (laydown == nullptr && on_the_fly_tracking_ == false) {
+    flatten_segments();
+    if (use_cache) {
+      TrackingCache::insert(
+          cache_key, std::make_shared<TrackLaydown>(TrackLaydown{
+                         tracks_, seg_lengths_, seg_codes16_, seg_codes32_,
+                         seg_min_, seg_scale_, seg_fsrs_, nfsrs_}));
+    }
+  }
 
+  // The track connections refer to the offsets of the boundary fluxes
   allocate_track_fluxes();
 
+  spdlog::info("Determining track connections");
+  set_bcs();
+  renumber_fsrs_by_tracks();
+  build_exp_table();
+  list_tracks();
+
   draw_timer.stop();
   spdlog::info("Time spent dawing tracks: {:.5} s.", draw_timer.elapsed_time());
 }
 
+// Largest code of a quantized segment length
+inline double max_segment_code(SegmentEncoding encoding) {
+  if (encoding == SegmentEncoding::Quantized16) {
+    return static_cast<double>(std::numeric_limits<std::uint16_t>::max());
+  }
+  return static_cast<double>(std::numeric_limits<std::uint32_t>::max());
+}
+
+TrackingMemory MOCDriver::estimate_tracking_memory(
+    std::uint32_t n_angles, double d, PolarQuadrature polar_quad) const {
+  check_tracking_parameters(n_angles, d);
+
+  std::size_t n_pol = polar_quad.sin().size();
+  if (anisotropic_) n_pol *= 2;
+
+  // The number of segments per unit length is estimated for each angle from
+  // a sample of its tracks, and extrapolated to the total track length
+  const std::vector<AngleInfo> angle_info = azimuthal_quadrature(n_angles, d);
+  const std::vector<TrackStart> starts = track_starts(angle_info);
+
+  std::vector<std::size_t> samples;
+  for (std::size_t t = 0; t < starts.size(); t++) {
+    const auto& ai = angle_info[starts[t].angle];
+    const std::size_t stride = std::max<std::size_t>(
+        1, (ai.nx + ai.ny) / MEMORY_SAMPLE_TRACKS);
+    if (starts[t].index % stride == 0) samples.push_back(t);
+  }
+
+  std::vector<std::size_t> sample_segs(samples.size(), 0);
+#pragma omp parallel for schedule(dynamic)
+  for (int is = 0; is < static_cast<int>(samples.size()); is++) {
+    const TrackStart& ts = starts[samples[static_cast<std::size_t>(is)]];
+    const Direction u(angle_info[ts.angle].phi);
+    sample_segs[static_cast<std::size_t>(is)] =
+        this->trace_fsr_segments(ts.r, u).size();
+  }
+
+  std::vector<double> sampled_length(angle_info.size(), 0.);
+  std::vector<double> sampled_segs(angle_info.size(), 0.);
+  for (std::size_t is = 0; is < samples.size(); is++) {
+    const TrackStart& ts = starts[samples[is]];
+    sampled_length[ts.angle] += ts.length;
+    sampled_segs[ts.angle] += static_cast<double>(sample_segs[is]);
+  }
+
+  double nsegs = 0.;
+  double max_segs = 0.;
+  for (const auto& ts : starts) {
+    const double rate = sampled_length[ts.angle] > 0.
+                            ? sampled_segs[ts.angle] / sampled_length[ts.angle]
+                            : 0.;
+    nsegs += rate * ts.length;
+    max_segs = std::max(max_segs, rate * ts.length);
+  }
+
+  TrackingMemory mem;
+  mem.num_tracks = starts.size();
+  mem.num_segments = static_cast<std::size_t>(std::ceil(nsegs));
+
+  // Boundary fluxes, and outgoing fluxes for the track parallel sweep
+  std::size_t track_fluxes = 2 * ngroups_ * n_pol;
+  if (sweep_parallelism_ == SweepParallelism::Tracks) track_fluxes *= 2;
+  mem.track_memory =
+      mem.num_tracks * (sizeof(Track) + sizeof(Track*) + sizeof(std::size_t) +
+                        track_fluxes * sizeof(MOCReal));
+
+  std::size_t seg_size = sizeof(std::uint32_t);
+  if (segment_encoding_ == SegmentEncoding::Double) {
+    seg_size += sizeof(MOCReal);
+  } else if (segment_encoding_ == SegmentEncoding::Quantized16) {
+    seg_size += sizeof(std::uint16_t);
+  } else {
+    seg_size += sizeof(std::uint32_t);
+  }
+  if (cmfd_) seg_size += 2 * sizeof(std::uint32_t);
+  mem.stored_memory = mem.num_segments * seg_size;
+  if (segment_encoding_ != SegmentEncoding::Double) {
+    // Minimum and scale of the lengths by angle and FSR, and decoding buffers
+    mem.stored_memory +=
+        2 * angle_info.size() * nfsrs_ * sizeof(double) +
+        max_threads() * static_cast<std::size_t>(std::ceil(max_segs)) *
+            sizeof(MOCReal);
+  }
+
+  mem.on_the_fly_memory =
+      angle_info.size() * nfsrs_ * sizeof(double) +
+      max_threads() * static_cast<std::size_t>(std::ceil(max_segs)) *
+          (sizeof(MOCReal) + sizeof(std::uint32_t));
+
+  // With a modular laydown, each track lists the tiles it crosses. The
+  // chords themselves are not counted.
+  const auto tile_size = geometry_->uniform_tile_size();
+  if (modular_tracking_ && tile_size) {
+    double ncrossings = 0.;
+    for (const auto& ts : starts) {
+      const Direction u(angle_info[ts.angle].phi);
+      ncrossings += ts.length * (std::abs(u.x()) / tile_size->first +
+                                 std::abs(u.y()) / tile_size->second) +
+                    2.;
+    }
+    mem.on_the_fly_memory +=
+        static_cast<std::size_t>(std::ceil(ncrossings)) * sizeof(ChordRef) +
+        nfsrs_ * sizeof(std::uint32_t);
+  }
+
+  return mem;
+}
+
+void MOCDriver::set_initial_flux(const MOCDriver& other) {
+  if (this->drawn() == false) {
+    auto mssg = "Cannot seed the flux before the geometry has been traced.";
+    spdlog::error(mssg);
+    throw ScarabeeException(mssg);
+  }
+
+  if (other.solved() == false) {
+    auto mssg = "Cannot seed the flux from an MOCDriver which is not solved.";
+    spdlog::error(mssg);
+    throw ScarabeeException(mssg);
+  }
+
+  if (other.ngroups_ != ngroups_ || other.nfsrs_ != nfsrs_ ||
+      other.anisotropic_ != anisotropic_) {
+    auto mssg =
+        "Cannot seed the flux from an MOCDriver with a different number of "
+        "groups or flat source regions, or a different scattering treatment.";
+    spdlog::error(mssg);
+    throw ScarabeeException(mssg);
+  }
+
+  // The flux is copied in the internal FSR numbering, which must then be the
+  // same for both drivers
+  if (other.fsr_original_indx_ != fsr_original_indx_) {
+    auto mssg =
+        "Cannot seed the flux from an MOCDriver with a different FSR "
+        "numbering.";
+    spdlog::error(mssg);
+    throw ScarabeeException(mssg);
+  }
+
+  // The boundary angular fluxes are only meaningful for the same tracks
+  bool same_tracking =
+      other.geometry_->geometry_hash() == geometry_->geometry_hash() &&
+      other.n_pol_angles_ == n_pol_angles_ &&
+      other.angle_info_.size() == angle_info_.size() &&
+      other.tracks_.size() == tracks_.size() &&
+      other.boundary_flux_.shape() == boundary_flux_.shape();
+  for (std::size_t a = 0; same_tracking && a < angle_info_.size(); a++) {
+    const AngleInfo& ai = angle_info_[a];
+    const AngleInfo& oai = other.angle_info_[a];
+    same_tracking = oai.phi == ai.phi && oai.d == ai.d && oai.nx == ai.nx &&
+                    oai.ny == ai.ny;
+  }
+  for (std::size_t a = 0; same_tracking && a < tracks_.size(); a++) {
+    same_tracking = other.tracks_[a].size() == tracks_[a].size();
+    for (std::size_t t = 0; same_tracking && t < tracks_[a].size(); t++) {
+      same_tracking = other.tracks_[a][t].num_segments() ==
+                      tracks_[a][t].num_segments();
+    }
+  }
+  if (same_tracking == false) {
+    auto mssg = "Cannot seed the flux from an MOCDriver with other tracks.";
+    spdlog::error(mssg);
+    throw ScarabeeException(mssg);
+  }
+
+  flux_ = other.flux_;
+  keff_ = other.keff_;
+  boundary_flux_ = other.boundary_flux_;
+  warm_start_ = true;
+}
+
+void MOCDriver::set_initial_flux(const std::string& fname) {
+  this->set_initial_flux(*MOCDriver::load_bin(fname));
+}
+
+void MOCDriver::set_initial_flux(const xt::xtensor<double, 2>& flux,
+                                 double keff) {
+  if (this->drawn() == false) {
+    auto mssg = "Cannot seed the flux before the geometry has been traced.";
+    spdlog::error(mssg);
+    throw ScarabeeException(mssg);
+  }
+
+  if (anisotropic_) {
+    auto mssg =
+        "Seeding a scalar flux is only available for isotropic problems.";
+    spdlog::error(mssg);
+    throw ScarabeeException(mssg);
+  }
+
+  if (flux.shape()[0] != ngroups_ || flux.shape()[1] != nfsrs_) {
+    auto mssg = "Initial flux must have a shape of (ngroups, nfsrs).";
+    spdlog::error(mssg);
+    throw ScarabeeException(mssg);
+  }
+
+  if (keff <= 0.) {
+    auto mssg = "Initial keff must be > 0.";
+    spdlog::error(mssg);
+    throw ScarabeeException(mssg);
+  }
+
+  // The provided flux uses the original FSR numbering
+  flux_.resize({ngroups_, nfsrs_, 1});
+  for (std::size_t g = 0; g < ngroups_; g++) {
+    for (std::size_t i = 0; i < nfsrs_; i++) {
+      flux_(g, internal_fsr_indx(i), 0) = flux(g, i);
+    }
+  }
+  keff_ = keff;
+
+  // The angular flux entering each track is isotropic, with the scalar flux
+  // of the FSR at that end of the track. The segments hold internal indices.
+  const double isotropic = 1. / (4. * PI);
+  for (const Track* track : track_list_) {
+    const TrackSegments segs = this->track_segments(*track);
+    if (segs.size == 0) continue;
+    const std::size_t i_entry = segs.fsrs[0];
+    const std::size_t i_exit = segs.fsrs[segs.size - 1];
+    for (std::size_t g = 0; g < ngroups_; g++) {
+      MOCReal* forw_in = boundary_flux(track->entry_flux_offset(), g);
+      MOCReal* back_in = boundary_flux(track->exit_flux_offset(), g);
+      for (std::size_t p = 0; p < n_pol_angles_; p++) {
+        forw_in[p] = static_cast<MOCReal>(isotropic * flux_(g, i_entry, 0));
+        back_in[p] = static_cast<MOCReal>(isotropic * flux_(g, i_exit, 0));
+      }
+    }
+  }
+
+  warm_start_ = true;
+}
+
+void MOCDriver::initialize_solution(std::size_t n_moments,
+                                    double boundary_flux) {
+  const std::array<std::size_t, 3> shape{ngroups_, nfsrs_, n_moments};
+  const bool seeded = warm_start_ && flux_.shape() == shape;
+  if (warm_start_ && seeded == false) {
+    spdlog::warn("Seeded flux does not match the problem and is not used.");
+  }
+  warm_start_ = false;
+
+  if (seeded) {
+    spdlog::info("Starting from the seeded flux, keff: {:.5f}", keff_);
+    return;
+  }
+
+  flux_.resize(shape);
+  flux_.fill(mode_ == SimulationMode::Keff ? 1. : 0.);
+  keff_ = 1.;
+  boundary_flux_.fill(static_cast<MOCReal>(boundary_flux));
+}
+
 void MOCDriver::solve() {
   Timer sim_timer;
   sim_timer.start();
@@ -193,6 +561,74 @@ void MOCDriver::solve() {
   }
   spdlog::info("Flux tolerance: {:.5E}", flux_tol_);
 
+  if (transport_solver_ == TransportSolver::GMRES) {
+    if (anisotropic_) {
+      auto mssg = "The GMRES solver is only available for isotropic problems.";
+      spdlog::error(mssg);
+      throw ScarabeeException(mssg);
+    }
+
+    if (cmfd_ && mode_ == SimulationMode::Keff) {
+      auto mssg = "CMFD acceleration cannot be used with the GMRES solver.";
+      spdlog::error(mssg);
+      throw ScarabeeException(mssg);
+    }
+
+    // The Krylov vectors hold the boundary angular fluxes, which would be
+    // truncated to single precision at every operator application.
+    if (std::is_same_v<MOCReal, double> == false) {
+      auto mssg =
+          "The GMRES solver cannot be used with mixed precision MOC sweeps.";
+      spdlog::error(mssg);
+      throw ScarabeeException(mssg);
+    }
+
+    spdlog::info("Using the GMRES solver.");
+  }
+
+  if (on_the_fly_tracking_) {
+    // Tracks are retraced once per sweep, which requires all groups of a
+    // track to be swept by the same work item. Gauss-Seidel sweeps one group
+    // at a time, and group parallelism sweeps each group block separately.
+    if (energy_iteration_ == EnergyIteration::GaussSeidel &&
+        anisotropic_ == false &&
+        transport_solver_ != TransportSolver::GMRES) {
+      auto mssg =
+          "On-the-fly tracking cannot be used with Gauss-Seidel energy "
+          "iterations.";
+      spdlog::error(mssg);
+      throw ScarabeeException(mssg);
+    }
+
+    // The anisotropic sweep shares the tracks of one group at a time among
+    // the threads, so the tracks would be retraced for every group.
+    if (anisotropic_ && ngroups_ > 1) {
+      auto mssg =
+          "On-the-fly tracking cannot be used with anisotropic scattering "
+          "and more than one group.";
+      spdlog::error(mssg);
+      throw ScarabeeException(mssg);
+    }
+
+    const bool single_block = ngroups_ == 1 || group_block_size_ >= ngroups_;
+    if (sweep_parallelism_ == SweepParallelism::Groups &&
+        single_block == false) {
+      auto mssg =
+          "On-the-fly tracking with group parallelism requires a group block "
+          "size holding all groups. Use track parallelism instead.";
+      spdlog::error(mssg);
+      throw ScarabeeException(mssg);
+    }
+  }
+
+  if (cmfd_) {
+    if (mode_ == SimulationMode::Keff) {
+      spdlog::info("Using CMFD acceleration.");
+    } else {
+      spdlog::warn("CMFD acceleration is only applied to keff problems.");
+    }
+  }
+
   if (mode_ == SimulationMode::FixedSource) {
     // Make sure extern_src_ is not all zero. Otherwise, we have no source !
     bool all_zero_extern_src = true;
@@ -215,9 +651,17 @@ void MOCDriver::solve() {
     }
   }
 
+  fill_total_xs();
+  fill_material_sources();
+  sweep_busy_time_.reset();
+
   if (anisotropic_ == false) {
     // isotropic
-    solve_isotropic();
+    if (transport_solver_ == TransportSolver::GMRES) {
+      solve_isotropic_krylov();
+    } else {
+      solve_isotropic();
+    }
   } else {
     // anisotropic
     solve_anisotropic();
@@ -228,12 +672,11 @@ void MOCDriver::solve() {
   sim_timer.stop();
   spdlog::info("");
   spdlog::info("Simulation Time: {:.5E} s", sim_timer.elapsed_time());
+  sweep_busy_time_.log("Sweep");
 }
 
 // solve for the isotropic
 void MOCDriver::solve_isotropic() {
-  flux_.resize({ngroups_, nfsrs_, 1});
-  flux_.fill(0.);
   xt::xtensor<double, 2> src;
   src.resize({ngroups_, nfsrs_});
   src.fill(0.);
@@ -252,24 +695,11 @@ void MOCDriver::solve_isotropic() {
     }
   }
 
-  // Initialize flux and keff
-  if (mode_ == SimulationMode::Keff) {
-    flux_.fill(1.);
-  } else {
-    flux_.fill(0.);
-  }
-  keff_ = 1.;
+  // Initialize flux, keff, and angular flux
+  initialize_solution(1, 1. / (4. * PI));
   auto next_flux = flux_;
   double prev_keff = keff_;
 
-  // Initialize angular flux
-  for (auto& tracks : tracks_) {
-    for (auto& track : tracks) {
-      track.entry_flux().fill(1. / (4. * PI));
-      track.exit_flux().fill(1. / (4. * PI));
-    }
-  }
-
   double rel_diff_keff = 100.;
   if (mode_ == SimulationMode::FixedSource) {
     rel_diff_keff = 0.;
@@ -277,57 +707,86 @@ void MOCDriver::solve_isotropic() {
   double max_flx_diff = 100;
   std::size_t iteration = 0;
   Timer iteration_timer;
+  // Chebyshev extrapolation is not combined with CMFD, which already
+  // accelerates the outer iterations
+  const bool extrapolate = chebyshev_acceleration_ &&
+                           mode_ == SimulationMode::Keff && cmfd_ == nullptr;
+  ChebyshevAcceleration chebyshev;
+  // The boundary angular fluxes are part of the iterate, and are extrapolated
+  // with the scalar flux. The sweep overwrites them, so the inputs are kept.
+  std::vector<MOCReal> old_boundary_flux;
+  if (extrapolate) old_boundary_flux.resize(boundary_flux_.size());
   while (rel_diff_keff > keff_tol_ || max_flx_diff > flux_tol_) {
     iteration_timer.reset();
     iteration_timer.start();
     iteration++;
 
-    fill_source(src, flux_);
-    src += extern_src_;
+    if (extrapolate) {
+      std::copy(boundary_flux_.begin(), boundary_flux_.end(),
+                old_boundary_flux.begin());
+    }
 
-    // Check for negative source values at beginning of simulation
     bool set_neg_src_to_zero = false;
-    if (iteration <= 20) {
-      for (std::size_t i = 0; i < src.size(); i++) {
-        if (src.flat(i) < 0.) {
-          src.flat(i) = 0.;
-          set_neg_src_to_zero = true;
+    if (energy_iteration_ == EnergyIteration::GaussSeidel) {
+      if (cmfd_ && mode_ == SimulationMode::Keff) cmfd_->zero_currents();
+      std::copy(flux_.begin(), flux_.end(), next_flux.begin());
+      set_neg_src_to_zero =
+          sweep_gauss_seidel(next_flux, src, D, iteration <= 20);
+    } else {
+      fill_source(src, flux_);
+
+      // Add the external source, and check for negative source values at
+      // beginning of simulation
+      const bool clip_neg_src = iteration <= 20;
+#pragma omp parallel for reduction(|| : set_neg_src_to_zero)
+      for (int ig = 0; ig < static_cast<int>(ngroups_); ig++) {
+        const std::size_t g = static_cast<std::size_t>(ig);
+        for (std::size_t i = 0; i < nfsrs_; i++) {
+          src(g, i) += extern_src_(g, i);
+          if (clip_neg_src && src(g, i) < 0.) {
+            src(g, i) = 0.;
+            set_neg_src_to_zero = true;
+          }
         }
       }
-    }
 
-    next_flux.fill(0.);
-    sweep(next_flux, src);
+      next_flux.fill(0.);
+      if (cmfd_ && mode_ == SimulationMode::Keff) cmfd_->zero_currents();
+      sweep(next_flux, src);
 
-    // Apply stabalization (see [1])
-    for (std::size_t g = 0; g < ngroups_; g++) {
-      for (std::size_t i = 0; i < nfsrs_; i++) {
-        if (D(g, i) != 0.) {
-          next_flux(g, i, 0) += flux_(g, i, 0) * D(g, i);
-          next_flux(g, i, 0) /= (1. + D(g, i));
+      // Apply stabalization (see [1])
+      for (std::size_t g = 0; g < ngroups_; g++) {
+        for (std::size_t i = 0; i < nfsrs_; i++) {
+          if (D(g, i) != 0.) {
+            next_flux(g, i, 0) += flux_(g, i, 0) * D(g, i);
+            next_flux(g, i, 0) /= (1. + D(g, i));
+          }
         }
       }
     }
 
+    if (extrapolate) {
+      chebyshev.extrapolate<MOCReal>(
+          {flux_.data(), flux_.size()}, {next_flux.data(), next_flux.size()},
+          old_boundary_flux, {boundary_flux_.data(), boundary_flux_.size()});
+    }
+
     if (mode_ == SimulationMode::Keff) {
       prev_keff = keff_;
       keff_ = calc_keff(next_flux, flux_);
       rel_diff_keff = std::abs(keff_ - prev_keff) / keff_;
     }
 
-    // Get difference
-    max_flx_diff = xt::amax(xt::abs(next_flux - flux_) / next_flux)();
-
-    // Make sure that the flux is positive everywhere !
+    // Get difference, and make sure that the flux is positive everywhere !
     bool set_neg_flux_to_zero = false;
-    for (std::size_t i = 0; i < next_flux.size(); i++) {
-      if (next_flux.flat(i) < 0.) {
-        next_flux.flat(i) = 0.;
-        set_neg_flux_to_zero = true;
-      }
-    }
+    max_flx_diff = max_flux_diff(next_flux, set_neg_flux_to_zero);
+    std::swap(flux_, next_flux);
 
-    flux_ = next_flux;
+    // Accelerate the flux and keff with CMFD
+    if (cmfd_ && mode_ == SimulationMode::Keff) {
+      cmfd_->solve(*this);
+      rel_diff_keff = std::abs(keff_ - prev_keff) / keff_;
+    }
 
     iteration_timer.stop();
     spdlog::info("-------------------------------------");
@@ -349,104 +808,246 @@ void MOCDriver::solve_isotropic() {
       spdlog::warn("Negative flux values set to zero");
     }
   }
-}
-
-// solve for anisotropic
-void MOCDriver::solve_anisotropic() {
-  N_lj_ = (max_L_ + 1) * (max_L_ + 1);
-  flux_.resize({ngroups_, nfsrs_, N_lj_});
-  flux_.fill(0.);
-
-  xt::xtensor<double, 3> src;
-  src.resize({ngroups_, nfsrs_, N_lj_});
-  src.fill(0.);
-
-  // get the polar angles and azimuthal angle
-  // to pre-caluculate the spherical harmonics
-  std::span<const double> pol_angl = polar_quad_.polar_angle();
-  std::vector<double> polar_angles(pol_angl.begin(), pol_angl.end());
-  std::vector<double> azimuthal_angles;
-  const std::size_t n_track_angles_ = angle_info_.size();
-  azimuthal_angles.reserve(n_track_angles_);
-  for (auto& ai : angle_info_) {
-    azimuthal_angles.push_back(ai.phi);
-  }
 
-  sph_harm_ = SphericalHarmonics(max_L_, azimuthal_angles, polar_angles);
+  iterations_ = iteration;
+}
 
-  // Initialize flux and keff
-  if (mode_ == SimulationMode::Keff) {
-    flux_.fill(1.);
-  } else {
-    flux_.fill(0.);
-  }
-  keff_ = 1.;
+void MOCDriver::solve_isotropic_krylov() {
+  // The unknowns are the scalar flux and the incoming angular flux of all
+  // tracks. One sweep is an affine map F(x) = L x + b of these unknowns, and
+  // the fixed point x = F(x) is found by solving (I - L) x = b with GMRES.
+  // For keff problems, the fission source is lagged and updated by power
+  // iteration around the linear solves.
+  // Initialize flux, keff, and angular flux
+  initialize_solution(1, mode_ == SimulationMode::Keff ? 1. / (4. * PI) : 0.);
   auto next_flux = flux_;
   double prev_keff = keff_;
 
-  // Initialize angular flux
-  for (auto& tracks : tracks_) {
-    for (auto& track : tracks) {
-      track.entry_flux().fill(1. / std::sqrt(4. * PI));
-      track.exit_flux().fill(1. / std::sqrt(4. * PI));
-    }
-  }
-
-  double rel_diff_keff = 100.;
-  if (mode_ == SimulationMode::FixedSource) {
-    rel_diff_keff = 0.;
-  }
-
-  double max_flx_diff = 100;
+  const std::size_t nstate = ngroups_ * nfsrs_ + boundary_flux_.size();
+  Eigen::VectorXd x(static_cast<Eigen::Index>(nstate));
+  Eigen::VectorXd b(static_cast<Eigen::Index>(nstate));
+  xt::xtensor<double, 2> fixed_src;
+  fixed_src.resize({ngroups_, nfsrs_});
+  xt::xtensor<double, 2> src;
+  src.resize({ngroups_, nfsrs_});
+  xt::xtensor<double, 3> sflux;
+  sflux.resize({ngroups_, nfsrs_, 1});
+
+  // For fixed source problems the fission source is part of the operator
+  const bool fission_in_operator = mode_ == SimulationMode::FixedSource;
+
+  // The operator is I - L, where L is the sweep with the scattering source of
+  // the state x, and no fixed source
+  const LinearOperator A = [&](const Eigen::Ref<const Eigen::VectorXd>& xin,
+                               Eigen::Ref<Eigen::VectorXd> y) {
+    unpack_krylov_state(xin, sflux);
+    fill_source(src, sflux, true, fission_in_operator);
+    sflux.fill(0.);
+    sweep(sflux, src);
+    pack_krylov_state(sflux, y);
+    y = xin - y;
+  };
+
+  // The Krylov basis holds krylov_restart + 1 copies of the state
+  GMRES gmres(nstate, krylov_restart_);
+  spdlog::info("GMRES Krylov basis: {} vectors of {} values, {:.2f} MiB.",
+               krylov_restart_ + 1, nstate,
+               static_cast<double>(gmres.memory()) / (1024. * 1024.));
+
+  double rel_diff_keff = mode_ == SimulationMode::Keff ? 100. : 0.;
+  double max_flx_diff = 100.;
   std::size_t iteration = 0;
+  std::size_t krylov_iterations = 0;
+  std::size_t operator_applications = 0;
   Timer iteration_timer;
   while (rel_diff_keff > keff_tol_ || max_flx_diff > flux_tol_) {
     iteration_timer.reset();
     iteration_timer.start();
     iteration++;
 
-    fill_source_anisotropic(src, flux_);
-    xt::view(src, xt::all(), xt::all(), 0) += extern_src_;
-
-    // Check for negative zero moment source values at beginning of simulation
-    bool set_neg_src_to_zero = false;
-    if (iteration <= 20) {
-      for (std::size_t g = 0; g < ngroups_; g++) {
-        for (std::size_t i = 0; i < nfsrs_; i++) {
-          if (src(g, i, 0) < 0.) {
-            src(g, i, 0) = 0;
-            set_neg_src_to_zero = true;
-          }
-        }
+    if (mode_ == SimulationMode::Keff) {
+      fill_source(fixed_src, flux_, false, true);
+    } else {
+      fixed_src.fill(0.);
+    }
+    for (std::size_t g = 0; g < ngroups_; g++) {
+      for (std::size_t i = 0; i < nfsrs_; i++) {
+        fixed_src(g, i) += extern_src_(g, i);
       }
     }
 
-    next_flux.fill(0.);
-    sweep_anisotropic(next_flux, src);
+    // The initial guess is the current solution. The right hand side is the
+    // sweep of the fixed source alone, without incoming angular flux.
+    pack_krylov_state(flux_, x);
+    std::fill(boundary_flux_.begin(), boundary_flux_.end(), MOCReal(0.));
+    std::copy(fixed_src.begin(), fixed_src.end(), src.begin());
+    sflux.fill(0.);
+    sweep(sflux, src);
+    pack_krylov_state(sflux, b);
+
+    const GMRESResult res =
+        gmres.solve(A, b, x, MAX_KRYLOV_ITERATIONS, flux_tol_);
+    krylov_iterations += res.iterations;
+    operator_applications += res.operator_applications + 1;
+    if (res.converged == false) {
+      spdlog::warn("GMRES did not converge, relative residual {:.5E}.",
+                   res.residual);
+    }
 
+    unpack_krylov_state(x, next_flux);
+
+    // Get difference, and make sure that the flux is positive everywhere !
+    bool set_neg_flux_to_zero = false;
     if (mode_ == SimulationMode::Keff) {
       prev_keff = keff_;
       keff_ = calc_keff(next_flux, flux_);
       rel_diff_keff = std::abs(keff_ - prev_keff) / keff_;
+      max_flx_diff = max_flux_diff(next_flux, set_neg_flux_to_zero);
+    } else {
+      // The fixed source problem is solved by a single linear solve
+      max_flux_diff(next_flux, set_neg_flux_to_zero);
+      max_flx_diff = 0.;
     }
 
-    // Get difference
-    auto new_flux = xt::view(next_flux, xt::all(), xt::all(), 0);
-    auto old_flux = xt::view(flux_, xt::all(), xt::all(), 0);
-    max_flx_diff = xt::amax(xt::abs(new_flux - old_flux) / new_flux)();
+    std::swap(flux_, next_flux);
 
-    // Make sure that the zero-moment flux is positive everywhere !
-    bool set_neg_flux_to_zero = false;
-    for (std::size_t g = 0; g < ngroups_; g++) {
+    iteration_timer.stop();
+    spdlog::info("-------------------------------------");
+    if (mode_ == SimulationMode::Keff) {
+      spdlog::info("Iteration {:>4d}          keff: {:.5f}", iteration, keff_);
+      spdlog::info("     keff difference:     {:.5E}", rel_diff_keff);
+      spdlog::info("     max flux difference: {:.5E}", max_flx_diff);
+    } else if (mode_ == SimulationMode::FixedSource) {
+      spdlog::info("Iteration {:>4d}", iteration);
+    }
+    spdlog::info("     GMRES iterations:    {}", res.iterations);
+    spdlog::info("     GMRES residual:      {:.5E}", res.residual);
+    spdlog::info("     iteration time: {:.5E} s",
+                 iteration_timer.elapsed_time());
+
+    if (set_neg_flux_to_zero) {
+      spdlog::warn("Negative flux values set to zero");
+    }
+  }
+
+  iterations_ = iteration;
+  spdlog::info("-------------------------------------");
+  spdlog::info("Total GMRES iterations: {}", krylov_iterations);
+  spdlog::info("Total sweeps: {}", operator_applications);
+}
+
+void MOCDriver::pack_krylov_state(const xt::xtensor<double, 3>& flux,
+                                  Eigen::Ref<Eigen::VectorXd> x) const {
+  const std::size_t n_phi = ngroups_ * nfsrs_;
+  std::copy_n(flux.data(), n_phi, x.data());
+  std::copy_n(boundary_flux_.data(), boundary_flux_.size(), x.data() + n_phi);
+}
+
+void MOCDriver::unpack_krylov_state(const Eigen::Ref<const Eigen::VectorXd>& x,
+                                    xt::xtensor<double, 3>& flux) {
+  const std::size_t n_phi = ngroups_ * nfsrs_;
+  std::copy_n(x.data(), n_phi, flux.data());
+  std::copy_n(x.data() + n_phi, boundary_flux_.size(), boundary_flux_.data());
+}
+
+// solve for anisotropic
+void MOCDriver::solve_anisotropic() {
+  N_lj_ = (max_L_ + 1) * (max_L_ + 1);
+
+  xt::xtensor<double, 3> src;
+  src.resize({ngroups_, nfsrs_, N_lj_});
+  src.fill(0.);
+
+  // get the polar angles and azimuthal angle
+  // to pre-caluculate the spherical harmonics
+  std::span<const double> pol_angl = polar_quad_.polar_angle();
+  std::vector<double> polar_angles(pol_angl.begin(), pol_angl.end());
+  std::vector<double> azimuthal_angles;
+  const std::size_t n_track_angles_ = angle_info_.size();
+  azimuthal_angles.reserve(n_track_angles_);
+  for (auto& ai : angle_info_) {
+    azimuthal_angles.push_back(ai.phi);
+  }
+
+  sph_harm_ = SphericalHarmonics(max_L_, azimuthal_angles, polar_angles);
+
+  // Initialize flux, keff, and angular flux
+  initialize_solution(N_lj_, 1. / std::sqrt(4. * PI));
+  auto next_flux = flux_;
+  double prev_keff = keff_;
+
+  double rel_diff_keff = 100.;
+  if (mode_ == SimulationMode::FixedSource) {
+    rel_diff_keff = 0.;
+  }
+
+  double max_flx_diff = 100;
+  std::size_t iteration = 0;
+  Timer iteration_timer;
+  // Chebyshev extrapolation is not combined with CMFD, which already
+  // accelerates the outer iterations
+  const bool extrapolate = chebyshev_acceleration_ &&
+                           mode_ == SimulationMode::Keff && cmfd_ == nullptr;
+  ChebyshevAcceleration chebyshev;
+  // The boundary angular fluxes are part of the iterate, and are extrapolated
+  // with the scalar flux. The sweep overwrites them, so the inputs are kept.
+  std::vector<MOCReal> old_boundary_flux;
+  if (extrapolate) old_boundary_flux.resize(boundary_flux_.size());
+  while (rel_diff_keff > keff_tol_ || max_flx_diff > flux_tol_) {
+    iteration_timer.reset();
+    iteration_timer.start();
+    iteration++;
+
+    if (extrapolate) {
+      std::copy(boundary_flux_.begin(), boundary_flux_.end(),
+                old_boundary_flux.begin());
+    }
+
+    fill_source_anisotropic(src, flux_);
+
+    // Add the external source, and check for negative zero moment source
+    // values at beginning of simulation
+    bool set_neg_src_to_zero = false;
+    const bool clip_neg_src = iteration <= 20;
+#pragma omp parallel for reduction(|| : set_neg_src_to_zero)
+    for (int ig = 0; ig < static_cast<int>(ngroups_); ig++) {
+      const std::size_t g = static_cast<std::size_t>(ig);
       for (std::size_t i = 0; i < nfsrs_; i++) {
-        if (next_flux(g, i, 0) < 0.) {
-          next_flux(g, i, 0) = 0;
-          set_neg_flux_to_zero = true;
+        src(g, i, 0) += extern_src_(g, i);
+        if (clip_neg_src && src(g, i, 0) < 0.) {
+          src(g, i, 0) = 0;
+          set_neg_src_to_zero = true;
         }
       }
     }
 
-    flux_ = next_flux;
+    next_flux.fill(0.);
+    if (cmfd_ && mode_ == SimulationMode::Keff) cmfd_->zero_currents();
+    sweep_anisotropic(next_flux, src);
+
+    if (extrapolate) {
+      chebyshev.extrapolate<MOCReal>(
+          {flux_.data(), flux_.size()}, {next_flux.data(), next_flux.size()},
+          old_boundary_flux, {boundary_flux_.data(), boundary_flux_.size()});
+    }
+
+    if (mode_ == SimulationMode::Keff) {
+      prev_keff = keff_;
+      keff_ = calc_keff(next_flux, flux_);
+      rel_diff_keff = std::abs(keff_ - prev_keff) / keff_;
+    }
+
+    // Get difference, and make sure that the zero-moment flux is positive
+    // everywhere !
+    bool set_neg_flux_to_zero = false;
+    max_flx_diff = max_flux_diff(next_flux, set_neg_flux_to_zero);
+    std::swap(flux_, next_flux);
+
+    // Accelerate the flux and keff with CMFD
+    if (cmfd_ && mode_ == SimulationMode::Keff) {
+      cmfd_->solve(*this);
+      rel_diff_keff = std::abs(keff_ - prev_keff) / keff_;
+    }
 
     iteration_timer.stop();
     spdlog::info("-------------------------------------");
@@ -468,217 +1069,692 @@ void MOCDriver::solve_anisotropic() {
       spdlog::warn("Negative zero-moment-flux values set to zero.");
     }
   }
+
+  iterations_ = iteration;
 }
 
-void MOCDriver::sweep(xt::xtensor<double, 3>& sflux,
-                      const xt::xtensor<double, 2>& src) {
-#pragma omp parallel for
-  for (int ig = 0; ig < static_cast<int>(ngroups_); ig++) {
-    std::size_t g = static_cast<std::size_t>(ig);
+// Evaluates 1 - exp(-tau) for a batch of optical thicknesses, with the table
+// when one is provided
+inline MOCBatch batch_mexp(const MOCBatch& tau, const ExpTable* exp_table) {
+  if (exp_table == nullptr) return mexp<MOCBatch, MOCReal>(tau);
+  return (*exp_table)(tau);
+}
+
+// Sum of x * y over NB SIMD batches. In mixed precision, the products are
+// summed in double, so that only the attenuation itself is rounded to single
+// precision and not the per-segment reductions.
+template <std::size_t NB>
+inline double polar_dot(const MOCReal* x, const MOCReal* y) {
+  using batch = MOCBatch;
+  if constexpr (std::is_same_v<MOCReal, double>) {
+    batch sum(0.);
+    for (std::size_t k = 0; k < NB; k++) {
+      const std::size_t p = k * batch::size;
+      sum = xsimd::fma(batch::load_aligned(x + p), batch::load_aligned(y + p),
+                       sum);
+    }
+    return xsimd::reduce_add(sum);
+  } else {
+    double sum = 0.;
+    for (std::size_t p = 0; p < NB * batch::size; p++) {
+      sum += static_cast<double>(x[p]) * static_cast<double>(y[p]);
+    }
+    return sum;
+  }
+}
 
-    for (auto& tracks : tracks_) {
-      for (std::size_t t = 0; t < tracks.size(); t++) {
-        auto& track = tracks[t];
-        const double tw = 4. * PI * track.wgt() *
-                          track.width();  // Azimuthal weight * track width
+// Attenuates the angular flux over a segment for all polar angles with an
+// isotropic source. All arrays hold NB SIMD batches. Returns the sum of the
+// changes in angular flux, weighted by wsin.
+template <std::size_t NB>
+inline double attenuate_isotropic(MOCReal* angflux, const MOCReal* invs_sin,
+                                  const MOCReal* wsin, double lEt, double Q_Et,
+                                  const ExpTable* exp_table) {
+  using batch = MOCBatch;
+  const batch lEt_b(static_cast<MOCReal>(lEt));
+  const batch Q_Et_b(static_cast<MOCReal>(Q_Et));
+  alignas(64) std::array<MOCReal, NB * batch::size> delta_flx;
+  for (std::size_t k = 0; k < NB; k++) {
+    const std::size_t p = k * batch::size;
+    const batch tau = lEt_b * batch::load_aligned(invs_sin + p);
+    batch psi = batch::load_aligned(angflux + p);
+    const batch delta = (psi - Q_Et_b) * batch_mexp(tau, exp_table);
+    psi -= delta;
+    psi.store_aligned(angflux + p);
+    delta.store_aligned(delta_flx.data() + p);
+  }
+  return polar_dot<NB>(wsin, delta_flx.data());
+}
+
+// Attenuates the angular flux over a segment for all polar angles, with a
+// different source for each polar angle. The changes in angular flux are
+// written to delta_flx. All arrays hold NB SIMD batches.
+template <std::size_t NB>
+inline void attenuate_anisotropic(MOCReal* angflux, MOCReal* delta_flx,
+                                  const MOCReal* Q_Et, const MOCReal* invs_sin,
+                                  double lEt, const ExpTable* exp_table) {
+  using batch = MOCBatch;
+  const batch lEt_b(static_cast<MOCReal>(lEt));
+  for (std::size_t k = 0; k < NB; k++) {
+    const std::size_t p = k * batch::size;
+    const batch tau = lEt_b * batch::load_aligned(invs_sin + p);
+    batch psi = batch::load_aligned(angflux + p);
+    const batch delta =
+        (psi - batch::load_aligned(Q_Et + p)) * batch_mexp(tau, exp_table);
+    psi -= delta;
+    psi.store_aligned(angflux + p);
+    delta.store_aligned(delta_flx + p);
+  }
+}
 
-        // Get the azimuthal angle (phi) and its cosine for CMFD current
-        const Direction u_forw = track.dir();
-        const Direction u_back = -u_forw;
+// Sum of the angular flux over all polar angles, weighted by wsin
+template <std::size_t NB>
+inline double polar_sum(const MOCReal* angflux, const MOCReal* wsin) {
+  return polar_dot<NB>(wsin, angflux);
+}
 
-        // Load the angular flux for forward direction
-        htl::static_vector<double, 6> angflux;
-        for (std::size_t p = 0; p < n_pol_angles_; p++)
-          angflux.push_back(track.entry_flux()(g, p));
+// Calls f with the number of SIMD batches of the padded polar quadrature as
+// a std::integral_constant, so that the sweep kernels are compiled with a
+// fixed trip count for the loops over the polar angles. The kernels are
+// instantiated for every count up to NMAX.
+template <std::size_t NMAX, typename F>
+inline void dispatch_polar_batches(std::size_t nb, F&& f) {
+  [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+    ((nb == Is + 1
+          ? (f(std::integral_constant<std::size_t, Is + 1>{}), true)
+          : false) ||
+     ...);
+  }(std::make_index_sequence<NMAX>{});
+}
 
-        // Follow track in forward direction
-        for (auto& seg : track) {
-          const std::size_t i = seg.fsr_indx();
-          const double l = seg.length();
-          const double Et = seg.xs()->Etr(g);
-          const double lEt = l * Et;
-          const double Q = src(g, i);
-          double delta_sum = 0.;
-          for (std::size_t p = 0; p < n_pol_angles_; p++) {
-            double exp_m1 = mexp(lEt * polar_quad_.invs_sin()[p]);
-            const double delta_flx = (angflux[p] - (Q / Et)) * exp_m1;
-            angflux[p] -= delta_flx;
-            delta_sum += polar_quad_.wsin()[p] * delta_flx;
-          }  // For all polar angles
-          sflux(g, i, 0) += tw * delta_sum;
-        }  // For all segments along forward direction of track
-
-        // Set incoming flux for next track
-        if (track.exit_bc() == BoundaryCondition::Vacuum) {
-          xt::view(track.exit_track_flux(), g, xt::all()).fill(0.);
-        } else {
-          for (std::size_t p = 0; p < n_pol_angles_; p++) {
-            track.exit_track_flux()(g, p) = angflux[p];
-          }
+// Calls f with the number of spherical harmonics as a std::integral_constant
+// for Legendre orders up to 3, and with zero for the higher orders, which
+// the anisotropic kernel then reads at run time.
+template <typename F>
+inline void dispatch_legendre_moments(std::size_t n_lj, F&& f) {
+  switch (n_lj) {
+    case 1:
+      f(std::integral_constant<std::size_t, 1>{});
+      break;
+    case 4:
+      f(std::integral_constant<std::size_t, 4>{});
+      break;
+    case 9:
+      f(std::integral_constant<std::size_t, 9>{});
+      break;
+    case 16:
+      f(std::integral_constant<std::size_t, 16>{});
+      break;
+    default:
+      f(std::integral_constant<std::size_t, 0>{});
+      break;
+  }
+}
+
+template <typename TrackSweeper>
+void MOCDriver::sweep_parallel_tracks(xt::xtensor<double, 3>& sflux,
+                                      std::size_t block_size,
+                                      TrackSweeper sweep_track,
+                                      std::size_t g_begin, std::size_t g_end) {
+  // Only the groups in [g_begin, g_end) are swept
+  const std::size_t ntracks = track_list_.size();
+  const std::size_t nblocks = (g_end - g_begin + block_size - 1) / block_size;
+
+  // Tracks traced on the fly are swept for all group blocks by the same work
+  // item, so that they are only traced once per sweep
+  const std::size_t item_blocks = on_the_fly_tracking_ ? nblocks : 1;
+  const std::size_t nitems = nblocks / item_blocks;
+  const std::size_t nwork = nitems * ntracks;
+
+  // Each thread tallies into its own copy of the scalar flux, and the
+  // outgoing angular fluxes are buffered so that no track reads an incoming
+  // flux while another thread writes it.
+  thread_flux_.resize(max_threads());
+  for (auto& tflux : thread_flux_) {
+    if (tflux.shape() != sflux.shape()) tflux.resize(sflux.shape());
+  }
+  const std::array<std::size_t, 4> out_shape{ntracks, 2, ngroups_,
+                                             n_pol_angles_};
+  if (track_out_flux_.shape() != out_shape) track_out_flux_.resize(out_shape);
+
+  // Tracks are handed out longest first, with all group blocks of a track
+  // following each other, and the guided schedule lets the short tracks at
+  // the end even out the load of the threads.
+#pragma omp parallel
+  {
+    auto& tflux = thread_flux_[thread_num()];
+    xt::view(tflux, xt::range(g_begin, g_end), xt::all(), xt::all()) = 0.;
+    Timer busy;
+    busy.start();
+
+#pragma omp for schedule(guided) nowait
+    for (int iw = 0; iw < static_cast<int>(nwork); iw++) {
+      const std::size_t w = static_cast<std::size_t>(iw);
+      const std::size_t t = track_order_[w / nitems];
+      Track& track = *track_list_[t];
+      const TrackSegments segs = this->track_segments(track);
+
+      const std::size_t b0 = (w % nitems) * item_blocks;
+      for (std::size_t b = b0; b < b0 + item_blocks; b++) {
+        const std::size_t g0 = g_begin + b * block_size;
+        const std::size_t g1 = std::min(g0 + block_size, g_end);
+        sweep_track(track, segs, g0, g1, tflux, &track_out_flux_(t, 0, g0, 0),
+                    &track_out_flux_(t, 1, g0, 0));
+      }
+    }
+
+    busy.stop();
+    sweep_busy_time_.add(busy.elapsed_time());
+  }
+
+  // Reduce the scalar flux tallies and pass the outgoing angular fluxes to
+  // the connected tracks. Each group is handled by a single thread.
+#pragma omp parallel for
+  for (int ig = static_cast<int>(g_begin); ig < static_cast<int>(g_end); ig++) {
+    const std::size_t g = static_cast<std::size_t>(ig);
+    for (const auto& tflux : thread_flux_) {
+      for (std::size_t i = 0; i < nfsrs_; i++) {
+        for (std::size_t lj = 0; lj < sflux.shape()[2]; lj++) {
+          sflux(g, i, lj) += tflux(g, i, lj);
         }
+      }
+    }
 
-        // Follow track in backwards direction
-        // First, load the backwards angular flux
-        for (std::size_t p = 0; p < n_pol_angles_; p++)
-          angflux[p] = track.exit_flux()(g, p);
+    for (std::size_t t = 0; t < ntracks; t++) {
+      const Track& track = *track_list_[t];
+      MOCReal* forw_in = boundary_flux(track.exit_track_flux_offset(), g);
+      MOCReal* back_in = boundary_flux(track.entry_track_flux_offset(), g);
+      for (std::size_t p = 0; p < n_pol_angles_; p++) {
+        forw_in[p] = track_out_flux_(t, 0, g, p);
+        back_in[p] = track_out_flux_(t, 1, g, p);
+      }
+    }
+  }
+}
 
-        // Iterate over segments in backwards direction
-        for (auto seg_it = track.rbegin(); seg_it != track.rend(); seg_it++) {
-          auto& seg = *seg_it;
-          const std::size_t i = seg.fsr_indx();
-          const double l = seg.length();
-          const double Et = seg.xs()->Etr(g);
-          const double lEt = l * Et;
-          const double Q = src(g, i);
-          double delta_sum = 0.;
-          for (std::size_t p = 0; p < n_pol_angles_; p++) {
-            double exp_m1 = mexp(lEt * polar_quad_.invs_sin()[p]);
-            const double delta_flx = (angflux[p] - (Q / Et)) * exp_m1;
-            angflux[p] -= delta_flx;
-            delta_sum += polar_quad_.wsin()[p] * delta_flx;
-          }  // For all polar angles
-          sflux(g, i, 0) += tw * delta_sum;
-        }  // For all segments along forward direction of track
-
-        // Set incoming flux for next track
-        if (track.entry_bc() == BoundaryCondition::Vacuum) {
-          xt::view(track.entry_track_flux(), g, xt::all()).fill(0.);
-        } else {
-          for (std::size_t p = 0; p < n_pol_angles_; p++) {
-            track.entry_track_flux()(g, p) = angflux[p];
+void MOCDriver::sweep(xt::xtensor<double, 3>& sflux,
+                      const xt::xtensor<double, 2>& src) {
+  const std::size_t block_size = group_block_size_;
+
+  // A single group uses a kernel which skips all group indexing. The threads
+  // still share the sweep as set by sweep_parallelism_.
+  const bool one_group = ngroups_ == 1;
+
+  if (block_size > 1 || one_group) {
+    // Source over total xs by FSR then group, so that the values for all
+    // groups in a block are contiguous
+    Q_Et_by_fsr_.resize({nfsrs_, ngroups_});
+#pragma omp parallel for
+    for (int ii = 0; ii < static_cast<int>(nfsrs_); ii++) {
+      const std::size_t i = static_cast<std::size_t>(ii);
+      for (std::size_t g = 0; g < ngroups_; g++) {
+        Q_Et_by_fsr_(i, g) = src(g, i) / Et_(g, i);
+      }
+    }
+  }
+
+  // The kernel is selected once for the whole sweep
+  dispatch_polar_batches<MAX_POLAR_BATCHES>(polar_batches(), [&](auto nb) {
+    constexpr std::size_t NB = decltype(nb)::value;
+
+    auto sweep_block = [this, &src, block_size, one_group](
+                           Track& track, const TrackSegments& segs,
+                           std::size_t g0, std::size_t g1,
+                           xt::xtensor<double, 3>& flx, MOCReal* forw_out,
+                           MOCReal* back_out) {
+      if (one_group) {
+        sweep_track_one_group<NB>(track, segs, flx, forw_out, back_out);
+      } else if (block_size > 1) {
+        sweep_track_block<NB>(track, segs, g0, g1, flx, forw_out, back_out);
+      } else {
+        sweep_track<NB>(track, segs, g0, flx, src, forw_out, back_out);
+      }
+    };
+
+    if (sweep_parallelism_ == SweepParallelism::Tracks) {
+      sweep_parallel_tracks(sflux, block_size, sweep_block, 0, ngroups_);
+      return;
+    }
+
+    // The last block may hold fewer groups, so blocks are handed out
+    // dynamically
+    const std::size_t nblocks = (ngroups_ + block_size - 1) / block_size;
+#pragma omp parallel
+    {
+      Timer busy;
+      busy.start();
+
+#pragma omp for schedule(dynamic) nowait
+      for (int ib = 0; ib < static_cast<int>(nblocks); ib++) {
+        const std::size_t g0 = static_cast<std::size_t>(ib) * block_size;
+        const std::size_t g1 = std::min(g0 + block_size, ngroups_);
+        for (auto& tracks : tracks_) {
+          for (auto& track : tracks) {
+            sweep_block(track, this->track_segments(track), g0, g1, sflux,
+                        boundary_flux(track.exit_track_flux_offset(), g0),
+                        boundary_flux(track.entry_track_flux_offset(), g0));
           }
         }
-      }  // For all tracks
-    }    // For all azimuthal angles
+      }
 
+      busy.stop();
+      sweep_busy_time_.add(busy.elapsed_time());
+    }
+  });
+
+#pragma omp parallel for
+  for (int ig = 0; ig < static_cast<int>(ngroups_); ig++) {
+    const std::size_t g = static_cast<std::size_t>(ig);
     for (std::size_t i = 0; i < nfsrs_; i++) {
-      const auto& mat = *fsrs_[i]->xs();
       const double Vi = fsrs_[i]->volume();
-      const double Et = mat.Etr(g);
+      const double Et = Et_(g, i);
       sflux(g, i, 0) *= 1. / (Vi * Et);
       sflux(g, i, 0) += 4. * PI * src(g, i) / Et;
     }
   }  // For all groups
 }
 
-// anisotropic sweep
-void MOCDriver::sweep_anisotropic(xt::xtensor<double, 3>& sflux,
-                                  const xt::xtensor<double, 3>& src) {
+bool MOCDriver::sweep_gauss_seidel(xt::xtensor<double, 3>& sflux,
+                                   xt::xtensor<double, 2>& src,
+                                   const xt::xtensor<double, 2>& D,
+                                   bool clip_negative_src) {
+  // Groups are swept from fast to thermal, each with a scattering source
+  // built from the most recent flux of all groups. The groups above the first
+  // one receiving upscatter are only swept once, while the upscatter block is
+  // swept upscatter_iterations_ times. The fission source is taken from the
+  // flux of the previous outer iteration, which is still held in flux_.
+  const double inv_k = 1. / keff_;
+  const double isotropic = 1. / (4. * PI);
+  bool set_neg_src_to_zero = false;
+
+  auto& fiss = fiss_src_;
+  std::fill(fiss.begin(), fiss.end(), 0.);
 #pragma omp parallel for
-  for (int ig = 0; ig < static_cast<int>(ngroups_); ig++) {
-    std::size_t g = static_cast<std::size_t>(ig);
-    for (auto& tracks : tracks_) {
-      for (std::size_t t = 0; t < tracks.size(); t++) {
-        auto& track = tracks[t];
-        htl::static_vector<double, 12> angflux;
-        for (std::size_t pp = 0; pp < n_pol_angles_; pp++)
-          angflux.push_back(track.entry_flux()(g, pp));
-        const double tw = 4. * PI * track.wgt() *
-                          track.width();  // Azimuthal weight * track width
-
-        // Follow track in forward direction
-        for (auto& seg : track) {
-          const std::size_t i = seg.fsr_indx();
-          const double l = seg.length();
-          const double Et = seg.xs()->Et(g);
-          const double lEt = l * Et;
-          const std::size_t phi_forward_index = track.phi_index_forward();
-
-          // loop over all polar angles
-          std::size_t p = 0;  // index for polar angle
-          for (std::size_t pp = 0; pp < n_pol_angles_; pp++) {
-            if (pp < n_pol_angles_ / 2) {
-              p = pp;
-            } else {
-              p = pp - n_pol_angles_ / 2;
-            }
+  for (int ib = 0; ib < static_cast<int>(source_blocks_.size()); ib++) {
+    const auto& blk = source_blocks_[static_cast<std::size_t>(ib)];
+    const auto& mat = material_sources_[blk.material];
+    if (mat.fissile == false) continue;
+    for (const auto i : blk.fsrs) {
+      double f = 0.;
+      for (std::size_t gg = 0; gg < ngroups_; gg++) {
+        f += mat.vEf(static_cast<Eigen::Index>(gg)) * flux_(gg, i, 0);
+      }
+      fiss[i] = inv_k * f;
+    }
+  }
 
-            double Q = 0.;
-            std::span<const double> Y_ljs =
-                sph_harm_.spherical_harmonics(phi_forward_index, pp);
-            for (std::size_t it_lj = 0; it_lj < N_lj_; it_lj++) {
-              Q += src(g, i, it_lj) * Y_ljs[it_lj];
-            }
+  auto sweep_group = [&](std::size_t g) {
+    const Eigen::Index G = static_cast<Eigen::Index>(g);
+    bool neg_src = false;
+#pragma omp parallel for reduction(|| : neg_src)
+    for (int ib = 0; ib < static_cast<int>(source_blocks_.size()); ib++) {
+      const auto& blk = source_blocks_[static_cast<std::size_t>(ib)];
+      const auto& mat = material_sources_[blk.material];
+      for (const auto i : blk.fsrs) {
+        double Q = mat.chi(G) * fiss[i];
+        for (std::size_t gg = 0; gg < ngroups_; gg++) {
+          Q += mat.scatter[0](G, static_cast<Eigen::Index>(gg)) *
+               sflux(gg, i, 0);
+        }
+        src(g, i) = isotropic * Q + extern_src_(g, i);
 
-            const double exp_m1 = mexp(lEt * polar_quad_.invs_sin()[p]);
-            const double delta_flx = (angflux[pp] - (Q / Et)) * exp_m1;
-            angflux[pp] -= delta_flx;
-            const double delta_sum = polar_quad_.wsin()[p] * delta_flx;
+        if (clip_negative_src && src(g, i) < 0.) {
+          src(g, i) = 0.;
+          neg_src = true;
+        }
+      }
+    }
+    if (neg_src) set_neg_src_to_zero = true;
+
+    xt::view(sflux, g, xt::all(), 0) = 0.;
+    dispatch_polar_batches<MAX_POLAR_BATCHES>(polar_batches(), [&](auto nb) {
+      constexpr std::size_t NB = decltype(nb)::value;
+      sweep_parallel_tracks(
+          sflux, 1,
+          [this, &src](Track& track, const TrackSegments& segs,
+                       std::size_t gt, std::size_t /*g1*/,
+                       xt::xtensor<double, 3>& flx, MOCReal* forw_out,
+                       MOCReal* back_out) {
+            sweep_track<NB>(track, segs, gt, flx, src, forw_out, back_out);
+          },
+          g, g + 1);
+    });
 
-            for (std::size_t it_lj = 0; it_lj < N_lj_; it_lj++) {
-              sflux(g, i, it_lj) += tw *
-                                    (delta_sum + l * Q * polar_quad_.wgt()[p]) *
-                                    Y_ljs[it_lj] * 0.5;
-            }
-          }  // For all polar angles
-        }    // For all segments along forward direction of track
+#pragma omp parallel for
+    for (int ii = 0; ii < static_cast<int>(nfsrs_); ii++) {
+      const std::size_t i = static_cast<std::size_t>(ii);
+      const double Vi = fsrs_[i]->volume();
+      const double Et = Et_(g, i);
+      sflux(g, i, 0) *= 1. / (Vi * Et);
+      sflux(g, i, 0) += 4. * PI * src(g, i) / Et;
 
-        // Set incoming flux for next track
-        if (track.exit_bc() == BoundaryCondition::Vacuum) {
-          xt::view(track.exit_track_flux(), g, xt::all()).fill(0.);
-        } else {
-          for (std::size_t pp = 0; pp < n_pol_angles_; pp++) {
-            track.exit_track_flux()(g, pp) = angflux[pp];
-          }
-        }
+      // Apply stabalization (see [1])
+      if (D(g, i) != 0.) {
+        sflux(g, i, 0) += flux_(g, i, 0) * D(g, i);
+        sflux(g, i, 0) /= (1. + D(g, i));
+      }
+    }
+  };
 
-        // Follow track in backwards direction
-        for (std::size_t pp = 0; pp < n_pol_angles_; pp++)
-          angflux[pp] = track.exit_flux()(g, pp);
+  for (std::size_t g = 0; g < first_upscatter_group_; g++) sweep_group(g);
 
-        for (auto seg_it = track.rbegin(); seg_it != track.rend(); seg_it++) {
-          auto& seg = *seg_it;
-          const std::size_t i = seg.fsr_indx();
-          const double l = seg.length();
-          const double Et = seg.xs()->Et(g);
-          const double lEt = l * Et;
-          const std::size_t phi_backward_index = track.phi_index_backward();
-
-          // loop over all polar angles
-          std::size_t p = 0;
-          for (std::size_t pp = 0; pp < n_pol_angles_; pp++) {
-            if (pp < n_pol_angles_ / 2) {
-              p = pp;
-            } else {
-              p = pp - n_pol_angles_ / 2;
-            }
+  // CMFD currents are only tallied on the last pass over the upscatter block
+  for (std::size_t it = 0; it < upscatter_iterations_; it++) {
+    skip_cmfd_tally_ = it + 1 < upscatter_iterations_;
+    for (std::size_t g = first_upscatter_group_; g < ngroups_; g++) {
+      sweep_group(g);
+    }
+  }
+  skip_cmfd_tally_ = false;
 
-            // source term evaluation for given azimuthal and polar angle
-            double Q = 0.;
-            std::span<const double> Y_ljs =
-                sph_harm_.spherical_harmonics(phi_backward_index, pp);
-            for (std::size_t it_lj = 0; it_lj < N_lj_; it_lj++) {
-              Q += src(g, i, it_lj) * Y_ljs[it_lj];
-            }
+  return set_neg_src_to_zero;
+}
 
-            const double exp_m1 = mexp(lEt * polar_quad_.invs_sin()[p]);
-            const double delta_flx = (angflux[pp] - (Q / Et)) * exp_m1;
-            angflux[pp] -= delta_flx;
-            const double delta_sum = polar_quad_.wsin()[p] * delta_flx;
+template <std::size_t NB>
+void MOCDriver::sweep_track(Track& track, const TrackSegments& segs,
+                            std::size_t g, xt::xtensor<double, 3>& sflux,
+                            const xt::xtensor<double, 2>& src,
+                            MOCReal* forw_out, MOCReal* back_out) {
+  const bool tally_cmfd =
+      cmfd_ && mode_ == SimulationMode::Keff && skip_cmfd_tally_ == false;
+  const std::size_t G = tally_cmfd ? cmfd_->moc_to_cmfd_group(g) : 0;
+  const ExpTable* exp_table =
+      exp_evaluator_ == ExpEvaluator::Table ? &exp_table_ : nullptr;
+  const MOCReal* invs_sin = pq_invs_sin_.data();
+  const MOCReal* wsin = pq_wsin_.data();
+
+  // Angular flux, padded with zeros to NB SIMD batches
+  constexpr std::size_t n_pad = NB * MOCBatch::size;
+  alignas(64) std::array<MOCReal, n_pad> angflux;
+  angflux.fill(0.);
+
+  const double tw = 4. * PI * track.wgt() *
+                    track.width();  // Azimuthal weight * track width
+
+  // Get the azimuthal angle (phi) and its cosine for CMFD current
+  const Direction u_forw = track.dir();
+  const Direction u_back = -u_forw;
+
+  // The CMFD surfaces are only stored, starting at the segment offset of the
+  // track
+  const std::size_t ns = segs.size;
+  const std::size_t sc = track.segment_offset();
+
+  // Load the angular flux for forward direction
+  for (std::size_t p = 0; p < n_pol_angles_; p++)
+    angflux[p] = boundary_flux(track.entry_flux_offset(), g)[p];
+
+  // Tally the current entering at the start of the track
+  if (tally_cmfd && ns > 0 && seg_entry_cmfd_[sc] != NO_CMFD_SURFACE) {
+    const double cur = polar_sum<NB>(angflux.data(), wsin);
+    cmfd_->tally_current(tw * cur, u_forw, G, seg_entry_cmfd_[sc]);
+  }
+
+  // Follow track in forward direction
+  for (std::size_t s = 0; s < ns; s++) {
+    const std::size_t i = segs.fsrs[s];
+    const double l = segs.lengths[s];
+    const double Et = Et_(g, i);
+    const double lEt = l * Et;
+    const double Q = src(g, i);
+    const double delta_sum =
+        attenuate_isotropic<NB>(angflux.data(), invs_sin, wsin, lEt, Q / Et,
+                                exp_table);
+    sflux(g, i, 0) += tw * delta_sum;
+
+    // Tally the current crossing the end of the segment
+    if (tally_cmfd && seg_exit_cmfd_[sc + s] != NO_CMFD_SURFACE) {
+      const double cur = polar_sum<NB>(angflux.data(), wsin);
+      cmfd_->tally_current(tw * cur, u_forw, G, seg_exit_cmfd_[sc + s]);
+    }
+  }  // For all segments along forward direction of track
+
+  // Set incoming flux for next track
+  const bool exit_vac = track.exit_bc() == BoundaryCondition::Vacuum;
+  for (std::size_t p = 0; p < n_pol_angles_; p++)
+    forw_out[p] = static_cast<MOCReal>(exit_vac ? 0. : angflux[p]);
+
+  // Follow track in backwards direction
+  // First, load the backwards angular flux
+  for (std::size_t p = 0; p < n_pol_angles_; p++)
+    angflux[p] = boundary_flux(track.exit_flux_offset(), g)[p];
+
+  // Tally the current entering at the end of the track
+  if (tally_cmfd && ns > 0 && seg_exit_cmfd_[sc + ns - 1] != NO_CMFD_SURFACE) {
+    const double cur = polar_sum<NB>(angflux.data(), wsin);
+    cmfd_->tally_current(tw * cur, u_back, G, seg_exit_cmfd_[sc + ns - 1]);
+  }
+
+  // Iterate over segments in backwards direction
+  for (std::size_t s = ns; s-- > 0;) {
+    const std::size_t i = segs.fsrs[s];
+    const double l = segs.lengths[s];
+    const double Et = Et_(g, i);
+    const double lEt = l * Et;
+    const double Q = src(g, i);
+    const double delta_sum =
+        attenuate_isotropic<NB>(angflux.data(), invs_sin, wsin, lEt, Q / Et,
+                                exp_table);
+    sflux(g, i, 0) += tw * delta_sum;
+
+    // Tally the current crossing the start of the segment
+    if (tally_cmfd && seg_entry_cmfd_[sc + s] != NO_CMFD_SURFACE) {
+      const double cur = polar_sum<NB>(angflux.data(), wsin);
+      cmfd_->tally_current(tw * cur, u_back, G, seg_entry_cmfd_[sc + s]);
+    }
+  }  // For all segments along forward direction of track
 
-            for (std::size_t it_lj = 0; it_lj < N_lj_; it_lj++) {
-              sflux(g, i, it_lj) += tw *
-                                    (delta_sum + l * Q * polar_quad_.wgt()[p]) *
-                                    Y_ljs[it_lj] * 0.5;
-            }
-          }  // For all polar angles
-        }    // For all segments along forward direction of track
+  // Set incoming flux for next track
+  const bool entry_vac = track.entry_bc() == BoundaryCondition::Vacuum;
+  for (std::size_t p = 0; p < n_pol_angles_; p++)
+    back_out[p] = static_cast<MOCReal>(entry_vac ? 0. : angflux[p]);
+}
 
-        // Set incoming flux for next track
-        if (track.entry_bc() == BoundaryCondition::Vacuum) {
-          xt::view(track.entry_track_flux(), g, xt::all()).fill(0.);
-        } else {
-          for (std::size_t pp = 0; pp < n_pol_angles_; pp++) {
-            track.entry_track_flux()(g, pp) = angflux[pp];
-          }
-        }
-      }  // For all tracks
-    }    // For all azimuthal angles
+template <std::size_t NB>
+void MOCDriver::sweep_track_block(Track& track, const TrackSegments& segs,
+                                  std::size_t g0, std::size_t g1,
+                                  xt::xtensor<double, 3>& sflux,
+                                  MOCReal* forw_out, MOCReal* back_out) {
+  // Sweeps the groups [g0, g1) along a track in a single pass, so that the
+  // segment data is only loaded once for the whole block. The outgoing
+  // angular fluxes are written with a stride of n_pol_angles_ per group.
+  const std::size_t nb = g1 - g0;
+  const bool tally_cmfd = cmfd_ && mode_ == SimulationMode::Keff;
+  const ExpTable* exp_table =
+      exp_evaluator_ == ExpEvaluator::Table ? &exp_table_ : nullptr;
+  const MOCReal* invs_sin = pq_invs_sin_.data();
+  const MOCReal* wsin = pq_wsin_.data();
+
+  // Angular flux for each group of the block, padded with zeros to NB SIMD
+  // batches
+  constexpr std::size_t n_pad = NB * MOCBatch::size;
+  using PolarArray = std::array<MOCReal, n_pad>;
+  alignas(64) std::array<PolarArray, MAX_GROUP_BLOCK> angflux;
+  for (std::size_t b = 0; b < nb; b++) angflux[b].fill(0.);
+
+  const double tw = 4. * PI * track.wgt() *
+                    track.width();  // Azimuthal weight * track width
+  const Direction u_forw = track.dir();
+  const Direction u_back = -u_forw;
+
+  // The CMFD surfaces are only stored, starting at the segment offset of the
+  // track
+  const std::size_t ns = segs.size;
+  const std::size_t sc = track.segment_offset();
+
+  auto tally_currents = [&](const Direction& u, std::size_t surf) {
+    for (std::size_t b = 0; b < nb; b++) {
+      const double cur = polar_sum<NB>(angflux[b].data(), wsin);
+      cmfd_->tally_current(tw * cur, u, cmfd_->moc_to_cmfd_group(g0 + b),
+                           surf);
+    }
+  };
+
+  auto attenuate = [&](std::size_t s) {
+    const std::size_t i = segs.fsrs[s];
+    const double l = segs.lengths[s];
+    const MOCReal* Et = &Et_by_fsr_(i, g0);
+    const double* Q_Et = &Q_Et_by_fsr_(i, g0);
+    for (std::size_t b = 0; b < nb; b++) {
+      const double delta_sum =
+          attenuate_isotropic<NB>(angflux[b].data(), invs_sin, wsin,
+                                  l * Et[b], Q_Et[b], exp_table);
+      sflux(g0 + b, i, 0) += tw * delta_sum;
+    }
+  };
+
+  // Follow track in forward direction
+  for (std::size_t b = 0; b < nb; b++) {
+    for (std::size_t p = 0; p < n_pol_angles_; p++)
+      angflux[b][p] = boundary_flux(track.entry_flux_offset(), g0 + b)[p];
+  }
+
+  if (tally_cmfd && ns > 0 && seg_entry_cmfd_[sc] != NO_CMFD_SURFACE) {
+    tally_currents(u_forw, seg_entry_cmfd_[sc]);
+  }
+
+  for (std::size_t s = 0; s < ns; s++) {
+    attenuate(s);
+    if (tally_cmfd && seg_exit_cmfd_[sc + s] != NO_CMFD_SURFACE) {
+      tally_currents(u_forw, seg_exit_cmfd_[sc + s]);
+    }
+  }
+
+  const bool exit_vac = track.exit_bc() == BoundaryCondition::Vacuum;
+  for (std::size_t b = 0; b < nb; b++) {
+    for (std::size_t p = 0; p < n_pol_angles_; p++)
+      forw_out[b * n_pol_angles_ + p] =
+          static_cast<MOCReal>(exit_vac ? 0. : angflux[b][p]);
+  }
+
+  // Follow track in backwards direction
+  for (std::size_t b = 0; b < nb; b++) {
+    for (std::size_t p = 0; p < n_pol_angles_; p++)
+      angflux[b][p] = boundary_flux(track.exit_flux_offset(), g0 + b)[p];
+  }
+
+  if (tally_cmfd && ns > 0 && seg_exit_cmfd_[sc + ns - 1] != NO_CMFD_SURFACE) {
+    tally_currents(u_back, seg_exit_cmfd_[sc + ns - 1]);
+  }
+
+  for (std::size_t s = ns; s-- > 0;) {
+    attenuate(s);
+    if (tally_cmfd && seg_entry_cmfd_[sc + s] != NO_CMFD_SURFACE) {
+      tally_currents(u_back, seg_entry_cmfd_[sc + s]);
+    }
+  }
+
+  const bool entry_vac = track.entry_bc() == BoundaryCondition::Vacuum;
+  for (std::size_t b = 0; b < nb; b++) {
+    for (std::size_t p = 0; p < n_pol_angles_; p++)
+      back_out[b * n_pol_angles_ + p] =
+          static_cast<MOCReal>(entry_vac ? 0. : angflux[b][p]);
+  }
+}
+
+template <std::size_t NB>
+void MOCDriver::sweep_track_one_group(Track& track, const TrackSegments& segs,
+                                      xt::xtensor<double, 3>& sflux,
+                                      MOCReal* forw_out, MOCReal* back_out) {
+  // Sweeps a track of a problem with a single group. The total xs and the
+  // source over total xs are read from contiguous arrays indexed by FSR, and
+  // the flux is tallied directly into the storage of sflux.
+  const bool tally_cmfd = cmfd_ && mode_ == SimulationMode::Keff;
+  const std::size_t G = tally_cmfd ? cmfd_->moc_to_cmfd_group(0) : 0;
+  const ExpTable* exp_table =
+      exp_evaluator_ == ExpEvaluator::Table ? &exp_table_ : nullptr;
+  const MOCReal* invs_sin = pq_invs_sin_.data();
+  const MOCReal* wsin = pq_wsin_.data();
+  const MOCReal* Et = Et_.data();
+  const double* Q_Et = Q_Et_by_fsr_.data();
+  double* phi = sflux.data();
+  const std::size_t phi_stride = sflux.shape()[2];
+
+  // Angular flux, padded with zeros to NB SIMD batches
+  constexpr std::size_t n_pad = NB * MOCBatch::size;
+  alignas(64) std::array<MOCReal, n_pad> angflux;
+  angflux.fill(0.);
+
+  const double tw = 4. * PI * track.wgt() *
+                    track.width();  // Azimuthal weight * track width
+  const Direction u_forw = track.dir();
+  const Direction u_back = -u_forw;
+
+  // The CMFD surfaces are only stored, starting at the segment offset of the
+  // track
+  const std::size_t ns = segs.size;
+  const std::size_t sc = track.segment_offset();
+
+  auto attenuate = [&](std::size_t s) {
+    const std::size_t i = segs.fsrs[s];
+    const double l = segs.lengths[s];
+    const double delta_sum = attenuate_isotropic<NB>(
+        angflux.data(), invs_sin, wsin, l * Et[i], Q_Et[i], exp_table);
+    phi[i * phi_stride] += tw * delta_sum;
+  };
+
+  auto tally_current = [&](const Direction& u, std::size_t surf) {
+    const double cur = polar_sum<NB>(angflux.data(), wsin);
+    cmfd_->tally_current(tw * cur, u, G, surf);
+  };
+
+  // Follow track in forward direction
+  for (std::size_t p = 0; p < n_pol_angles_; p++)
+    angflux[p] = boundary_flux(track.entry_flux_offset(), 0)[p];
+
+  if (tally_cmfd && ns > 0 && seg_entry_cmfd_[sc] != NO_CMFD_SURFACE) {
+    tally_current(u_forw, seg_entry_cmfd_[sc]);
+  }
+
+  for (std::size_t s = 0; s < ns; s++) {
+    attenuate(s);
+    if (tally_cmfd && seg_exit_cmfd_[sc + s] != NO_CMFD_SURFACE) {
+      tally_current(u_forw, seg_exit_cmfd_[sc + s]);
+    }
+  }
+
+  const bool exit_vac = track.exit_bc() == BoundaryCondition::Vacuum;
+  for (std::size_t p = 0; p < n_pol_angles_; p++)
+    forw_out[p] = static_cast<MOCReal>(exit_vac ? 0. : angflux[p]);
+
+  // Follow track in backwards direction
+  for (std::size_t p = 0; p < n_pol_angles_; p++)
+    angflux[p] = boundary_flux(track.exit_flux_offset(), 0)[p];
+
+  if (tally_cmfd && ns > 0 && seg_exit_cmfd_[sc + ns - 1] != NO_CMFD_SURFACE) {
+    tally_current(u_back, seg_exit_cmfd_[sc + ns - 1]);
+  }
+
+  for (std::size_t s = ns; s-- > 0;) {
+    attenuate(s);
+    if (tally_cmfd && seg_entry_cmfd_[sc + s] != NO_CMFD_SURFACE) {
+      tally_current(u_back, seg_entry_cmfd_[sc + s]);
+    }
+  }
 
+  const bool entry_vac = track.entry_bc() == BoundaryCondition::Vacuum;
+  for (std::size_t p = 0; p < n_pol_angles_; p++)
+    back_out[p] = static_cast<MOCReal>(entry_vac ? 0. : angflux[p]);
+}
+
+// anisotropic sweep
+void MOCDriver::sweep_anisotropic(xt::xtensor<double, 3>& sflux,
+                                  const xt::xtensor<double, 3>& src) {
+  // The kernel is selected once for the whole sweep
+  dispatch_polar_batches<MAX_POLAR_BATCHES>(polar_batches(), [&](auto nb) {
+    dispatch_legendre_moments(N_lj_, [&](auto nlj) {
+      constexpr std::size_t NB = decltype(nb)::value;
+      constexpr std::size_t NLJ = decltype(nlj)::value;
+      sweep_anisotropic_impl<NB, NLJ>(sflux, src);
+    });
+  });
+
+#pragma omp parallel for
+  for (int ig = 0; ig < static_cast<int>(ngroups_); ig++) {
+    const std::size_t g = static_cast<std::size_t>(ig);
     for (std::size_t i = 0; i < nfsrs_; i++) {
-      const auto& mat = *fsrs_[i]->xs();
       const double Vi = fsrs_[i]->volume();
-      const double Et = mat.Et(g);
+      const double Et = Et_(g, i);
       for (std::size_t it_lj = 0; it_lj < N_lj_; it_lj++) {
         sflux(g, i, it_lj) *= 1. / (Vi * Et);
       }
@@ -686,6 +1762,225 @@ void MOCDriver::sweep_anisotropic(xt::xtensor<double, 3>& sflux,
   }  // For all groups
 }
 
+template <std::size_t NB, std::size_t NLJ>
+void MOCDriver::sweep_anisotropic_impl(xt::xtensor<double, 3>& sflux,
+                                       const xt::xtensor<double, 3>& src) {
+  // The groups are swept one after the other, with the tracks of a group
+  // shared among the threads in both parallel modes. The angular source of
+  // the group is evaluated once per FSR and azimuthal angle in a table shared
+  // by all threads, and the segments tally the angular flux in a shared
+  // table, which is only projected onto the spherical harmonics once all
+  // tracks of the group have been swept. The outgoing angular fluxes are
+  // buffered, so that no track reads an incoming flux while another thread
+  // writes it.
+  const std::size_t ntracks = track_list_.size();
+  const std::size_t n_azi = 2 * angle_info_.size();
+  ang_src_.resize(nfsrs_ * n_azi * n_pol_pad_);
+  ang_flux_.resize(nfsrs_ * n_azi * n_pol_pad_);
+  const std::array<std::size_t, 4> out_shape{ntracks, 2, ngroups_,
+                                             n_pol_angles_};
+  if (track_out_flux_.shape() != out_shape) track_out_flux_.resize(out_shape);
+
+  for (std::size_t g = 0; g < ngroups_; g++) {
+    fill_angular_source<NLJ>(g, src);
+
+#pragma omp parallel
+    {
+      Timer busy;
+      busy.start();
+
+#pragma omp for schedule(guided) nowait
+      for (int it = 0; it < static_cast<int>(ntracks); it++) {
+        const std::size_t t = track_order_[static_cast<std::size_t>(it)];
+        Track& track = *track_list_[t];
+        sweep_track_anisotropic<NB>(track, this->track_segments(track), g,
+                                    &track_out_flux_(t, 0, g, 0),
+                                    &track_out_flux_(t, 1, g, 0));
+      }
+
+      busy.stop();
+      sweep_busy_time_.add(busy.elapsed_time());
+    }
+
+    // Pass the outgoing angular fluxes to the connected tracks
+#pragma omp parallel for
+    for (int it = 0; it < static_cast<int>(ntracks); it++) {
+      const std::size_t t = static_cast<std::size_t>(it);
+      const Track& track = *track_list_[t];
+      MOCReal* forw_in = boundary_flux(track.exit_track_flux_offset(), g);
+      MOCReal* back_in = boundary_flux(track.entry_track_flux_offset(), g);
+      for (std::size_t p = 0; p < n_pol_angles_; p++) {
+        forw_in[p] = track_out_flux_(t, 0, g, p);
+        back_in[p] = track_out_flux_(t, 1, g, p);
+      }
+    }
+
+    project_angular_flux<NLJ>(g, sflux);
+  }
+}
+
+template <std::size_t NB>
+void MOCDriver::sweep_track_anisotropic(Track& track,
+                                        const TrackSegments& segs,
+                                        std::size_t g, MOCReal* forw_out,
+                                        MOCReal* back_out) {
+  const bool tally_cmfd = cmfd_ && mode_ == SimulationMode::Keff;
+  const std::size_t G = tally_cmfd ? cmfd_->moc_to_cmfd_group(g) : 0;
+  const ExpTable* exp_table =
+      exp_evaluator_ == ExpEvaluator::Table ? &exp_table_ : nullptr;
+  const MOCReal* invs_sin = pq_invs_sin_.data();
+  const MOCReal* wsin = pq_wsin_.data();
+  const MOCReal* wgt = pq_wgt_.data();
+  const std::size_t n_azi = 2 * angle_info_.size();
+  const MOCReal* ang_src = ang_src_.data();
+  double* ang_flux = ang_flux_.data();
+
+  // Angular flux and change in angular flux for all polar angles, padded with
+  // zeros to NB SIMD batches
+  constexpr std::size_t n_pad = NB * MOCBatch::size;
+  alignas(64) std::array<MOCReal, n_pad> angflux;
+  alignas(64) std::array<MOCReal, n_pad> delta_flx;
+  angflux.fill(0.);
+  delta_flx.fill(0.);
+
+  for (std::size_t pp = 0; pp < n_pol_angles_; pp++)
+    angflux[pp] = boundary_flux(track.entry_flux_offset(), g)[pp];
+  const double tw = 4. * PI * track.wgt() *
+                    track.width();  // Azimuthal weight * track width
+  const Direction u_forw = track.dir();
+  const Direction u_back = -u_forw;
+
+  // The CMFD surfaces are only stored, starting at the segment offset of the
+  // track
+  const std::size_t ns = segs.size;
+  const std::size_t sc = track.segment_offset();
+
+  // Attenuates the angular flux over segment s, travelled along azimuthal
+  // index a, and tallies its contribution to the angular flux of the FSR.
+  // Tracks swept by other threads may tally the same FSR and azimuthal
+  // index, so the tallies are atomic.
+  auto attenuate_segment = [&](std::size_t s, std::size_t a) {
+    const std::size_t i = segs.fsrs[s];
+    const double lEt = static_cast<double>(segs.lengths[s]) * Et_(g, i);
+    const std::size_t offset = (i * n_azi + a) * n_pol_pad_;
+    const MOCReal* seg_Q_Et = ang_src + offset;
+
+    attenuate_anisotropic<NB>(angflux.data(), delta_flx.data(), seg_Q_Et,
+                              invs_sin, lEt, exp_table);
+
+    double* seg_flux = ang_flux + offset;
+    for (std::size_t pp = 0; pp < n_pol_angles_; pp++) {
+      const double f =
+          tw * (wsin[pp] * delta_flx[pp] + lEt * seg_Q_Et[pp] * wgt[pp]);
+#pragma omp atomic
+      seg_flux[pp] += f;
+    }
+  };
+
+  // Tally the current entering at the start of the track
+  if (tally_cmfd && ns > 0 && seg_entry_cmfd_[sc] != NO_CMFD_SURFACE) {
+    const double cur = polar_sum<NB>(angflux.data(), wsin);
+    cmfd_->tally_current(0.5 * tw * cur, u_forw, G, seg_entry_cmfd_[sc]);
+  }
+
+  // Follow track in forward direction
+  for (std::size_t s = 0; s < ns; s++) {
+    attenuate_segment(s, track.phi_index_forward());
+
+    // Tally the current crossing the end of the segment
+    if (tally_cmfd && seg_exit_cmfd_[sc + s] != NO_CMFD_SURFACE) {
+      const double cur = polar_sum<NB>(angflux.data(), wsin);
+      cmfd_->tally_current(0.5 * tw * cur, u_forw, G, seg_exit_cmfd_[sc + s]);
+    }
+  }  // For all segments along forward direction of track
+
+  // Set incoming flux for next track
+  const bool exit_vac = track.exit_bc() == BoundaryCondition::Vacuum;
+  for (std::size_t pp = 0; pp < n_pol_angles_; pp++)
+    forw_out[pp] = static_cast<MOCReal>(exit_vac ? 0. : angflux[pp]);
+
+  // Follow track in backwards direction
+  for (std::size_t pp = 0; pp < n_pol_angles_; pp++)
+    angflux[pp] = boundary_flux(track.exit_flux_offset(), g)[pp];
+
+  // Tally the current entering at the end of the track
+  if (tally_cmfd && ns > 0 && seg_exit_cmfd_[sc + ns - 1] != NO_CMFD_SURFACE) {
+    const double cur = polar_sum<NB>(angflux.data(), wsin);
+    cmfd_->tally_current(0.5 * tw * cur, u_back, G,
+                         seg_exit_cmfd_[sc + ns - 1]);
+  }
+
+  for (std::size_t s = ns; s-- > 0;) {
+    attenuate_segment(s, track.phi_index_backward());
+
+    // Tally the current crossing the start of the segment
+    if (tally_cmfd && seg_entry_cmfd_[sc + s] != NO_CMFD_SURFACE) {
+      const double cur = polar_sum<NB>(angflux.data(), wsin);
+      cmfd_->tally_current(0.5 * tw * cur, u_back, G, seg_entry_cmfd_[sc + s]);
+    }
+  }  // For all segments along forward direction of track
+
+  // Set incoming flux for next track
+  const bool entry_vac = track.entry_bc() == BoundaryCondition::Vacuum;
+  for (std::size_t pp = 0; pp < n_pol_angles_; pp++)
+    back_out[pp] = static_cast<MOCReal>(entry_vac ? 0. : angflux[pp]);
+}
+
+template <std::size_t NLJ>
+void MOCDriver::fill_angular_source(std::size_t g,
+                                    const xt::xtensor<double, 3>& src) {
+  const std::size_t n_azi = 2 * angle_info_.size();
+  // Number of flux moments, only read at run time above a Legendre order of 3
+  const std::size_t n_lj = NLJ == 0 ? N_lj_ : NLJ;
+
+  // The angular flux tallies of the group are zeroed at the same time
+#pragma omp parallel for
+  for (int ii = 0; ii < static_cast<int>(nfsrs_); ii++) {
+    const std::size_t i = static_cast<std::size_t>(ii);
+    const double inv_Et = 1. / Et_(g, i);
+    for (std::size_t a = 0; a < n_azi; a++) {
+      const std::size_t offset = (i * n_azi + a) * n_pol_pad_;
+      MOCReal* Q_Et = &ang_src_[offset];
+      double* flx = &ang_flux_[offset];
+      for (std::size_t pp = 0; pp < n_pol_pad_; pp++) {
+        Q_Et[pp] = 0.;
+        flx[pp] = 0.;
+      }
+
+      for (std::size_t pp = 0; pp < n_pol_angles_; pp++) {
+        std::span<const double> Y_ljs = sph_harm_.spherical_harmonics(a, pp);
+        double Q = 0.;
+        for (std::size_t it_lj = 0; it_lj < n_lj; it_lj++) {
+          Q += src(g, i, it_lj) * Y_ljs[it_lj];
+        }
+        Q_Et[pp] = static_cast<MOCReal>(Q * inv_Et);
+      }
+    }
+  }
+}
+
+template <std::size_t NLJ>
+void MOCDriver::project_angular_flux(std::size_t g,
+                                     xt::xtensor<double, 3>& sflux) const {
+  const std::size_t n_azi = 2 * angle_info_.size();
+  const std::size_t n_lj = NLJ == 0 ? N_lj_ : NLJ;
+
+#pragma omp parallel for
+  for (int ii = 0; ii < static_cast<int>(nfsrs_); ii++) {
+    const std::size_t i = static_cast<std::size_t>(ii);
+    for (std::size_t a = 0; a < n_azi; a++) {
+      const double* flx = &ang_flux_[(i * n_azi + a) * n_pol_pad_];
+      for (std::size_t pp = 0; pp < n_pol_angles_; pp++) {
+        std::span<const double> Y_ljs = sph_harm_.spherical_harmonics(a, pp);
+        const double f = 0.5 * flx[pp];
+        for (std::size_t it_lj = 0; it_lj < n_lj; it_lj++) {
+          sflux(g, i, it_lj) += f * Y_ljs[it_lj];
+        }
+      }
+    }
+  }
+}
+
 double MOCDriver::calc_keff(const xt::xtensor<double, 3>& flux,
                             const xt::xtensor<double, 3>& old_flux) const {
   double num = 0.;
@@ -721,78 +2016,165 @@ double MOCDriver::calc_keff(const xt::xtensor<double, 3>& flux,
   return keff_ * num / denom;
 }
 
+double MOCDriver::max_flux_diff(xt::xtensor<double, 3>& next_flux,
+                                bool& set_neg_flux_to_zero) const {
+  // The relative difference of the zero moments and the clipping of negative
+  // values are done in a single pass, without any temporary arrays.
+  double max_diff = 0.;
+  bool neg_flux = false;
+
+#pragma omp parallel for reduction(max : max_diff) reduction(|| : neg_flux)
+  for (int ig = 0; ig < static_cast<int>(ngroups_); ig++) {
+    const std::size_t g = static_cast<std::size_t>(ig);
+    for (std::size_t i = 0; i < nfsrs_; i++) {
+      const double nf = next_flux(g, i, 0);
+      const double diff = std::abs(nf - flux_(g, i, 0)) / nf;
+      if (diff > max_diff) max_diff = diff;
+
+      if (nf < 0.) {
+        next_flux(g, i, 0) = 0.;
+        neg_flux = true;
+      }
+    }
+  }
+
+  set_neg_flux_to_zero = neg_flux;
+  return max_diff;
+}
+
 void MOCDriver::fill_source(xt::xtensor<double, 2>& src,
-                            const xt::xtensor<double, 3>& flux) const {
+                            const xt::xtensor<double, 3>& flux, bool scatter,
+                            bool fission) {
   const double inv_k = 1. / keff_;
   const double isotropic = 1. / (4. * PI);
 
-#pragma omp parallel for
-  for (int ig = 0; ig < static_cast<int>(ngroups_); ig++) {
-    const std::size_t g = static_cast<std::size_t>(ig);
-    for (std::size_t i = 0; i < fsrs_.size(); i++) {
-      const auto& mat = *fsrs_[i]->xs();
-      const double chi_g = mat.chi(g);
-      double Qout = 0.;
-
-      for (std::uint32_t gg = 0; gg < ngroups_; gg++) {
-        // Sccatter source
-        const double flux_gg_i = flux(gg, i, 0);
-        const double Es_gg_to_g = mat.Es_tr(gg, g);
-        Qout += Es_gg_to_g * flux_gg_i;
-
-        // Fission source
-        const double vEf_gg = mat.vEf(gg);
-        Qout += inv_k * chi_g * vEf_gg * flux_gg_i;
+  // The source of each block of FSRs sharing a material is evaluated as a
+  // single product of the scattering matrix with the fluxes of the block
+#pragma omp parallel
+  {
+    auto& work = thread_src_work_[thread_num()];
+
+#pragma omp for schedule(dynamic)
+    for (int ib = 0; ib < static_cast<int>(source_blocks_.size()); ib++) {
+      const auto& blk = source_blocks_[static_cast<std::size_t>(ib)];
+      const auto& mat = material_sources_[blk.material];
+      const std::size_t n = blk.fsrs.size();
+
+      auto blk_flux = work.flux.leftCols(static_cast<Eigen::Index>(n));
+      auto blk_src = work.src.leftCols(static_cast<Eigen::Index>(n));
+      auto blk_fiss = work.fiss.head(static_cast<Eigen::Index>(n));
+      for (std::size_t k = 0; k < n; k++) {
+        for (std::size_t g = 0; g < ngroups_; g++) {
+          blk_flux(static_cast<Eigen::Index>(g), static_cast<Eigen::Index>(k)) =
+              flux(g, blk.fsrs[k], 0);
+        }
+      }
+
+      if (scatter) {
+        blk_src.noalias() = mat.scatter[0] * blk_flux;
+      } else {
+        blk_src.setZero();
       }
 
-      src(g, i) = isotropic * Qout;
+      if (fission && mat.fissile) {
+        // Fission source is a rank-1 update
+        blk_fiss.noalias() = inv_k * (mat.vEf.transpose() * blk_flux);
+        blk_src.noalias() += mat.chi * blk_fiss;
+      }
+
+      for (std::size_t k = 0; k < n; k++) {
+        for (std::size_t g = 0; g < ngroups_; g++) {
+          src(g, blk.fsrs[k]) =
+              isotropic * blk_src(static_cast<Eigen::Index>(g),
+                                  static_cast<Eigen::Index>(k));
+        }
+      }
     }
   }
 }
 
-void MOCDriver::fill_source_anisotropic(
-    xt::xtensor<double, 3>& src, const xt::xtensor<double, 3>& flux) const {
+void MOCDriver::fill_source_anisotropic(xt::xtensor<double, 3>& src,
+                                        const xt::xtensor<double, 3>& flux) {
   const double inv_k = 1. / keff_;
 
-#pragma omp parallel for
-  for (int ig = 0; ig < static_cast<int>(ngroups_); ig++) {
-    const std::size_t g = static_cast<std::size_t>(ig);
-    for (std::size_t i = 0; i < fsrs_.size(); i++) {
-      const auto& mat = *fsrs_[i]->xs();
-      const double chi_g = mat.chi(g);
+#pragma omp parallel
+  {
+    auto& work = thread_src_work_[thread_num()];
+
+#pragma omp for schedule(dynamic)
+    for (int ib = 0; ib < static_cast<int>(source_blocks_.size()); ib++) {
+      const auto& blk = source_blocks_[static_cast<std::size_t>(ib)];
+      const auto& mat = material_sources_[blk.material];
+      const std::size_t n = blk.fsrs.size();
+
+      auto blk_flux = work.flux.leftCols(static_cast<Eigen::Index>(n));
+      auto blk_src = work.src.leftCols(static_cast<Eigen::Index>(n));
+      auto blk_fiss = work.fiss.head(static_cast<Eigen::Index>(n));
 
       std::size_t it_lj = 0;
       for (std::size_t l = 0; l <= max_L_; l++) {
         for (int j = -static_cast<int>(l); j <= static_cast<int>(l); j++) {
-          double Qout = 0.;
-          for (std::uint32_t gg = 0; gg < ngroups_; gg++) {
-            // Sccatter source
-            const double flux_gg_i = flux(gg, i, it_lj);
-            const double Es_gg_to_g = mat.Es(l, gg, g);
-            Qout += Es_gg_to_g * flux_gg_i;
+          if (l < mat.scatter.size()) {
+            for (std::size_t k = 0; k < n; k++) {
+              for (std::size_t g = 0; g < ngroups_; g++) {
+                blk_flux(static_cast<Eigen::Index>(g),
+                         static_cast<Eigen::Index>(k)) =
+                    flux(g, blk.fsrs[k], it_lj);
+              }
+            }
+
+            blk_src.noalias() = mat.scatter[l] * blk_flux;
 
             // Fission source
-            if (l == 0) {
-              const double vEf_gg = mat.vEf(gg);
-              Qout += inv_k * chi_g * vEf_gg * flux_gg_i;
+            if (l == 0 && mat.fissile) {
+              blk_fiss.noalias() = inv_k * (mat.vEf.transpose() * blk_flux);
+              blk_src.noalias() += mat.chi * blk_fiss;
             }
+          } else {
+            // No scattering moment of this order for the material
+            blk_src.setZero();
           }
 
-          src(g, i, it_lj) = Qout;
+          for (std::size_t k = 0; k < n; k++) {
+            for (std::size_t g = 0; g < ngroups_; g++) {
+              src(g, blk.fsrs[k], it_lj) =
+                  blk_src(static_cast<Eigen::Index>(g),
+                          static_cast<Eigen::Index>(k));
+            }
+          }
           it_lj++;
 
         }  // -l to l
-      }    // all scattering moments L
-    }      // all flat souce regions
-  }        // all groups
+      }  // l = 0 to max_L_
+    }
+  }
 }
 
-void MOCDriver::generate_azimuthal_quadrature(std::uint32_t n_angles,
-                                              double d) {
-  spdlog::info("Creating quadrature");
-  spdlog::info("Number of azimuthal angles: {}", n_angles);
-  spdlog::info("Maximum track spacing: {} cm", d);
+void MOCDriver::check_tracking_parameters(std::uint32_t n_angles,
+                                          double d) const {
+  if (n_angles < 4) {
+    auto mssg = "MOCDriver must have at least 4 angles.";
+    spdlog::error(mssg);
+    throw ScarabeeException(mssg);
+  }
+
+  if (n_angles % 4 != 0) {
+    // If the number of angles isn't a multiple of 4, we won't be able to make
+    // all the boundary condition connections due to an odd number.
+    auto mssg = "MOCDriver number of angles must be a multiple of 4.";
+    spdlog::error(mssg);
+    throw ScarabeeException(mssg);
+  }
+
+  if (d <= 0.) {
+    auto mssg = "MOCDriver track spacing must be > 0.";
+    spdlog::error(mssg);
+    throw ScarabeeException(mssg);
+  }
+}
 
+std::vector<MOCDriver::AngleInfo> MOCDriver::azimuthal_quadrature(
+    std::uint32_t n_angles, double d) const {
   // Determine the angles and spacings for the tracks
   double delta_phi = 2. * PI / static_cast<double>(n_angles);
 
@@ -801,9 +2183,26 @@ void MOCDriver::generate_azimuthal_quadrature(std::uint32_t n_angles,
   // we only need [0, pi], and we can use tracks in the opposite direction.
   std::uint32_t n_track_angles_ = n_angles / 2;
 
-  angle_info_.resize(n_track_angles_, {0., 0., 0., 0, 0, 0, 0});
-  const double Dx = geometry_->x_max() - geometry_->x_min();
-  const double Dy = geometry_->y_max() - geometry_->y_min();
+  std::vector<AngleInfo> angle_info(n_track_angles_,
+                                    {0., 0., 0., 0, 0, 0, 0});
+  double Dx = geometry_->x_max() - geometry_->x_min();
+  double Dy = geometry_->y_max() - geometry_->y_min();
+
+  // For modular ray tracing, the tracks are laid down on a single tile and
+  // repeated over the lattice, so that they cross every tile at the same
+  // local positions.
+  std::uint32_t n_tiles_x = 1;
+  std::uint32_t n_tiles_y = 1;
+  if (modular_tracking_) {
+    const auto tile_size = geometry_->uniform_tile_size();
+    if (tile_size) {
+      Dx = tile_size->first;
+      Dy = tile_size->second;
+      n_tiles_x = static_cast<std::uint32_t>(geometry_->nx());
+      n_tiles_y = static_cast<std::uint32_t>(geometry_->ny());
+    }
+  }
+
   for (std::uint32_t i = 0; i < n_track_angles_; i++) {
     // Get the initial guess for phi_i
     double phi_i = delta_phi * (static_cast<double>(i) + 0.5);
@@ -814,62 +2213,70 @@ void MOCDriver::generate_azimuthal_quadrature(std::uint32_t n_angles,
 
     // Calculate information for a given angle, except the weight.
     // Weight is calculated once all angles are known.
-    angle_info_[i].phi = std::atan((Dy * nx) / (Dx * ny));
+    angle_info[i].phi = std::atan((Dy * nx) / (Dx * ny));
 
     // Fix angles between [pi/2, pi], due to arctan result domain
-    if (phi_i > 0.5 * PI) angle_info_[i].phi = PI - angle_info_[i].phi;
+    if (phi_i > 0.5 * PI) angle_info[i].phi = PI - angle_info[i].phi;
 
-    angle_info_[i].d = (Dx / nx) * std::sin(angle_info_[i].phi);
-    angle_info_[i].nx = static_cast<std::uint32_t>(nx);
-    angle_info_[i].ny = static_cast<std::uint32_t>(ny);
-    angle_info_[i].forward_index = i;
-    angle_info_[i].backward_index = i + n_track_angles_;
+    angle_info[i].d = (Dx / nx) * std::sin(angle_info[i].phi);
+    angle_info[i].nx = static_cast<std::uint32_t>(nx) * n_tiles_x;
+    angle_info[i].ny = static_cast<std::uint32_t>(ny) * n_tiles_y;
+    angle_info[i].forward_index = i;
+    angle_info[i].backward_index = i + n_track_angles_;
   }
 
   // Go through and calculate the angle weights
   for (std::uint32_t i = 0; i < n_track_angles_; i++) {
     if (i == 0) {
-      const double phi_0 = angle_info_[0].phi;
-      const double phi_1 = angle_info_[1].phi;
-      angle_info_[i].wgt = (1. / (2. * PI)) * (0.5 * (phi_1 - phi_0) + phi_0);
+      const double phi_0 = angle_info[0].phi;
+      const double phi_1 = angle_info[1].phi;
+      angle_info[i].wgt = (1. / (2. * PI)) * (0.5 * (phi_1 - phi_0) + phi_0);
     } else if (i == (n_track_angles_ - 1)) {
-      const double phi_im1 = angle_info_[i - 1].phi;
-      const double phi_i = angle_info_[i].phi;
-      angle_info_[i].wgt =
+      const double phi_im1 = angle_info[i - 1].phi;
+      const double phi_i = angle_info[i].phi;
+      angle_info[i].wgt =
           (1. / (2. * PI)) * (PI - phi_i + 0.5 * (phi_i - phi_im1));
     } else {
-      const double phi_im1 = angle_info_[i - 1].phi;
-      const double phi_ip1 = angle_info_[i + 1].phi;
-      angle_info_[i].wgt = (1. / (4. * PI)) * (phi_ip1 - phi_im1);
+      const double phi_im1 = angle_info[i - 1].phi;
+      const double phi_ip1 = angle_info[i + 1].phi;
+      angle_info[i].wgt = (1. / (4. * PI)) * (phi_ip1 - phi_im1);
+    }
+  }
+
+  return angle_info;
+}
+
+void MOCDriver::generate_azimuthal_quadrature(std::uint32_t n_angles,
+                                              double d) {
+  spdlog::info("Creating quadrature");
+  spdlog::info("Number of azimuthal angles: {}", n_angles);
+  spdlog::info("Maximum track spacing: {} cm", d);
+
+  if (modular_tracking_) {
+    if (geometry_->uniform_tile_size()) {
+      spdlog::info("Using modular ray tracing");
+    } else {
+      spdlog::warn("Tiles are not uniform. Modular ray tracing is disabled.");
     }
+  }
+
+  angle_info_ = azimuthal_quadrature(n_angles, d);
 
-    const auto& ai = angle_info_[i];
+  for (const auto& ai : angle_info_) {
     spdlog::debug("Angle {:.5E} pi: weight {:.5E}, width {:.5E}, nx {}, ny {}",
                   ai.phi / PI, ai.wgt, ai.d, ai.nx, ai.ny);
   }
 }
 
-void MOCDriver::trace_tracks() {
-  spdlog::info("Tracing tracks");
-
-  std::uint32_t n_track_angles_ =
-      static_cast<std::uint32_t>(angle_info_.size());
+std::vector<MOCDriver::TrackStart> MOCDriver::track_starts(
+    const std::vector<AngleInfo>& angle_info) const {
   const double Dx = geometry_->x_max() - geometry_->x_min();
   const double Dy = geometry_->y_max() - geometry_->y_min();
 
-  tracks_.resize(n_track_angles_);
-
-#pragma omp parallel for
-  for (int ii = 0; ii < static_cast<int>(n_track_angles_); ii++) {
-    const std::size_t i = static_cast<std::size_t>(ii);
-
-    const auto& ai = angle_info_[i];
-
-    // Allocate space for tracks associated with this angle
-    tracks_[i].reserve(ai.nx + ai.ny);
-
-    // Get direction for the track
-    Direction u(ai.phi);
+  std::vector<TrackStart> starts;
+  for (std::size_t i = 0; i < angle_info.size(); i++) {
+    const auto& ai = angle_info[i];
+    const Direction u(ai.phi);
 
     // spacing between starts in x
     const double dx = Dx / static_cast<double>(ai.nx);
@@ -877,85 +2284,249 @@ void MOCDriver::trace_tracks() {
     const double dy = Dy / static_cast<double>(ai.ny);
 
     // Depending on angle, we either start on the -x bound, or the +x bound
+    double x, y;
     if (ai.phi < 0.5 * PI) {
       // Start on -x boundary in upper left corner and move down
-      double x = geometry_->x_min();
-      double y =
-          dy * (static_cast<double>(ai.ny - 1) + 0.5) + geometry_->y_min();
-      for (std::uint32_t t = 0; t < (ai.nx + ai.ny); t++) {
+      x = geometry_->x_min();
+      y = dy * (static_cast<double>(ai.ny - 1) + 0.5) + geometry_->y_min();
+    } else {
+      // Start on -y boundary in lower left corner and move across and up
+      x = 0.5 * dx + geometry_->x_min();
+      y = geometry_->y_min();
+    }
+
+    for (std::uint32_t t = 0; t < (ai.nx + ai.ny); t++) {
+      if (ai.phi < 0.5 * PI) {
         if (t == ai.ny) {
           // Next, we move across the -y boundary
           y = geometry_->y_min();
           x = 0.5 * dx + geometry_->x_min();
         }
+      } else if (t == ai.nx) {
+        // Next, we move across the -y boundary
+        x = geometry_->x_max();
+        y = 0.5 * dy + geometry_->y_min();
+      }
 
-        Vector r_start(x, y);
-        Vector r_end = r_start;
-        std::vector<Segment> segments;
-        std::pair<UniqueFSR, Vector> fsr_r =
-            geometry_->get_fsr_r_local(r_end, u);
-        auto ti = geometry_->get_tile_index(r_end, u);
-        while (fsr_r.first.fsr && ti) {
-          const double d = fsr_r.first.fsr->distance(fsr_r.second, u);
-          segments.emplace_back(fsr_r.first.fsr, d,
-                                this->get_fsr_indx(fsr_r.first));
-
-          r_end = r_end + d * u;
-
-          ti = geometry_->get_tile_index(r_end, u);
-          if (ti) fsr_r = geometry_->get_fsr_r_local(r_end, u);
-        }
-
-        tracks_[i].emplace_back(r_start, r_end, u, ai.phi, ai.wgt, ai.d,
-                                segments, ai.forward_index, ai.backward_index);
+      // Length of the chord through the bounding box of the geometry
+      double lx = INF;
+      if (u.x() > 0.) lx = (geometry_->x_max() - x) / u.x();
+      if (u.x() < 0.) lx = (geometry_->x_min() - x) / u.x();
+      double ly = INF;
+      if (u.y() > 0.) ly = (geometry_->y_max() - y) / u.y();
+      if (u.y() < 0.) ly = (geometry_->y_min() - y) / u.y();
+      starts.push_back({i, t, Vector(x, y), std::min(lx, ly)});
 
+      if (ai.phi < 0.5 * PI) {
         if (t < ai.ny) {
           y -= dy;
         } else {
           x += dx;
         }
+      } else {
+        if (t < ai.nx) {
+          x += dx;
+        } else {
+          y += dy;
+        }
       }
-    } else {
-      // Start on -y boundary in lower left corner and move across and up
-      double x = 0.5 * dx + geometry_->x_min();
-      double y = geometry_->y_min();
-      for (std::uint32_t t = 0; t < (ai.nx + ai.ny); t++) {
-        if (t == ai.nx) {
-          // Next, we move across the -y boundary
-          x = geometry_->x_max();
-          y = 0.5 * dy + geometry_->y_min();
+    }
+  }
+
+  return starts;
+}
+
+void MOCDriver::trace_tracks() {
+  spdlog::info("Tracing tracks");
+
+  std::uint32_t n_track_angles_ =
+      static_cast<std::uint32_t>(angle_info_.size());
+
+  // With a modular laydown, tracks cross all tiles of the same type at the
+  // same local positions, so chords only need to be traced once.
+  const bool modular =
+      modular_tracking_ && geometry_->uniform_tile_size().has_value();
+
+  if (cmfd_) cmfd_->reset_fsr_lists();
+
+  // With on-the-fly tracking, the segments are discarded once their lengths
+  // have been tallied for the renormalization, and the chords are kept
+  otf_chords_.clear();
+  otf_chord_refs_.clear();
+  otf_max_length_ = 0.;
+  if (on_the_fly_tracking_) {
+    spdlog::info("Using on-the-fly tracking");
+    otf_renorm_ = xt::zeros<double>({angle_info_.size(), nfsrs_});
+    seg_lengths_ = std::vector<MOCReal>();
+    seg_fsrs_ = std::vector<std::uint32_t>();
+    seg_entry_cmfd_ = std::vector<std::uint32_t>();
+    seg_exit_cmfd_ = std::vector<std::uint32_t>();
+  } else {
+    otf_renorm_.resize({0, 0});
+  }
+
+  // Tracks are traced individually, longest first, as short corner tracks
+  // cost far less than those crossing the whole geometry.
+  const std::vector<TrackStart> starts = track_starts(angle_info_);
+  std::vector<double> lengths(starts.size());
+  for (std::size_t t = 0; t < starts.size(); t++) {
+    lengths[t] = starts[t].length;
+  }
+  const std::vector<std::size_t> order = longest_first_order(lengths);
+
+  tracks_.resize(n_track_angles_);
+  for (std::size_t i = 0; i < n_track_angles_; i++) {
+    tracks_[i].resize(angle_info_[i].nx + angle_info_[i].ny);
+  }
+
+  // Chords through the tiles are shared by all tracks of an angle, and each
+  // thread keeps its own maps
+  std::vector<std::vector<ChordMap>> thread_chords(max_threads());
+  if (modular) {
+    for (auto& chords : thread_chords) chords.resize(n_track_angles_);
+  }
+
+  ThreadBusyTime busy_time;
+  busy_time.reset();
+  double max_length = 0.;
+#pragma omp parallel
+  {
+    Timer busy;
+    busy.start();
+    auto& chords = thread_chords[thread_num()];
+
+#pragma omp for schedule(dynamic) nowait reduction(max : max_length)
+    for (int it = 0; it < static_cast<int>(order.size()); it++) {
+      const TrackStart& ts = starts[order[static_cast<std::size_t>(it)]];
+      const auto& ai = angle_info_[ts.angle];
+      Direction u(ai.phi);
+      ChordMap* chords_ptr = modular ? &chords[ts.angle] : nullptr;
+
+      Vector r_end = ts.r;
+      std::vector<Segment> segments;
+      this->trace_track_segments(r_end, u, segments, chords_ptr);
+
+      Track& track = tracks_[ts.angle][ts.index];
+      track = Track(ts.r, r_end, u, ai.phi, ai.wgt, ai.d, segments,
+                    ai.forward_index, ai.backward_index);
+
+      if (on_the_fly_tracking_) {
+        // Tally the approximate FSR volumes, and only keep the number of
+        // segments of the track
+        for (const auto& seg : segments) {
+#pragma omp atomic
+          otf_renorm_(ts.angle, seg.fsr_indx()) += seg.length() * ai.d;
+          max_length = std::max(max_length, seg.length());
         }
+        track.set_flattened(0);
+      }
+    }
+
+    busy.stop();
+    busy_time.add(busy.elapsed_time());
+  }
+  busy_time.log("Tracing");
+
+  if (on_the_fly_tracking_) {
+    otf_max_length_ = max_length;
 
-        Vector r_start(x, y);
-        Vector r_end = r_start;
-        std::vector<Segment> segments;
-        std::pair<UniqueFSR, Vector> fsr_r =
-            geometry_->get_fsr_r_local(r_end, u);
-        auto ti = geometry_->get_tile_index(r_end, u);
-        while (fsr_r.first.fsr && ti) {
-          const double d = fsr_r.first.fsr->distance(fsr_r.second, u);
-          segments.emplace_back(fsr_r.first.fsr, d,
-                                this->get_fsr_indx(fsr_r.first));
-
-          r_end = r_end + d * u;
-
-          ti = geometry_->get_tile_index(r_end, u);
-          if (ti) fsr_r = geometry_->get_fsr_r_local(r_end, u);
+    // Gather the chords traced by all threads
+    if (modular) {
+      otf_chords_.resize(n_track_angles_);
+      for (auto& chords : thread_chords) {
+        for (std::size_t a = 0; a < n_track_angles_; a++) {
+          otf_chords_[a].merge(chords[a]);
         }
+      }
+      this->build_chord_refs();
+    }
+  }
 
-        tracks_[i].emplace_back(r_start, r_end, u, ai.phi, ai.wgt, ai.d,
-                                segments, ai.forward_index, ai.backward_index);
+  if (cmfd_) cmfd_->pack_fsr_lists();
+}
 
-        if (t < ai.nx) {
-          x += dx;
-        } else {
-          y += dy;
+void MOCDriver::trace_track_segments(Vector& r, const Direction& u,
+                                     std::vector<Segment>& segments,
+                                     ChordMap* chords) {
+  auto ti = geometry_->get_tile_index(r, u);
+  while (ti) {
+    const Cartesian2D::TileIndex tile_indx = *ti;
+    std::vector<ChordSegment>* chord = nullptr;
+    ChordKey key;
+
+    if (chords) {
+      // Chords are identified by the tile contents and the local entry point
+      const auto& tile = geometry_->tile(tile_indx);
+      const void* contents =
+          tile.c2d ? static_cast<const void*>(tile.c2d.get())
+                   : static_cast<const void*>(tile.cell.get());
+      const Vector r_tile = r - geometry_->get_tile_center(tile_indx);
+      key = {contents, std::llround(r_tile.x() / CHORD_TOL),
+             std::llround(r_tile.y() / CHORD_TOL)};
+
+      auto it = chords->find(key);
+      if (it != chords->end()) {
+        for (const auto& cs : it->second) {
+          const UniqueFSR ufsr{
+              cs.fsr, cs.instance + geometry_->fsr_instance_offset(
+                                        tile_indx, cs.fsr->id())};
+          segments.emplace_back(cs.fsr, cs.length, this->get_fsr_indx(ufsr));
+
+          if (cmfd_) this->set_segment_cmfd_info(segments.back(), r, u);
+
+          r = r + cs.length * u;
         }
+
+        ti = geometry_->get_tile_index(r, u);
+        continue;
+      }
+
+      chord = &(*chords)[key];
+    }
+
+    // Trace the track until it leaves the tile
+    std::pair<UniqueFSR, Vector> fsr_r = geometry_->get_fsr_r_local(r, u);
+    while (ti && ti->i == tile_indx.i && ti->j == tile_indx.j) {
+      if (fsr_r.first.fsr == nullptr) {
+        // We are lost, so the track ends here. The chord is incomplete.
+        if (chords) chords->erase(key);
+        return;
+      }
+
+      const double d = fsr_r.first.fsr->distance(fsr_r.second, u);
+      segments.emplace_back(fsr_r.first.fsr, d,
+                            this->get_fsr_indx(fsr_r.first));
+
+      if (chord) {
+        const std::size_t offset = geometry_->fsr_instance_offset(
+            tile_indx, fsr_r.first.fsr->id());
+        chord->push_back(
+            {fsr_r.first.fsr, fsr_r.first.instance - offset, d, 0});
       }
+
+      if (cmfd_) this->set_segment_cmfd_info(segments.back(), r, u);
+
+      r = r + d * u;
+
+      ti = geometry_->get_tile_index(r, u);
+      if (ti) fsr_r = geometry_->get_fsr_r_local(r, u);
     }
   }
 }
 
+void MOCDriver::set_segment_cmfd_info(Segment& seg, const Vector& r,
+                                      const Direction& u) {
+  const Vector r_exit = r + seg.length() * u;
+  seg.entry_cmfd_surface() = cmfd_->get_surface(r, u);
+  seg.exit_cmfd_surface() = cmfd_->get_surface(r_exit, u);
+
+  const auto tile = cmfd_->get_tile(r + 0.5 * seg.length() * u, u);
+  if (tile) {
+#pragma omp critical
+    cmfd_->insert_fsr(*tile, seg.fsr_indx());
+  }
+}
+
 std::vector<std::pair<std::size_t, double>> MOCDriver::trace_fsr_segments(
     const Vector r_start, const Direction& u) const {
   std::vector<std::pair<std::size_t, double>> out;
@@ -983,16 +2554,20 @@ void MOCDriver::set_periodic_bcs_x() {
 
     if (ai.phi < PI_2) {
       for (std::size_t j = 0; j < ai.ny; j++) {
-        tracks[ai.nx + j].set_exit_track_flux(&tracks[j].entry_flux());
-        tracks[j].set_entry_track_flux(&tracks[ai.nx + j].exit_flux());
+        tracks[ai.nx + j].set_exit_track_flux_offset(
+            tracks[j].entry_flux_offset());
+        tracks[j].set_entry_track_flux_offset(
+            tracks[ai.nx + j].exit_flux_offset());
 
         tracks[ai.nx + j].exit_bc() = BoundaryCondition::Periodic;
         tracks[j].entry_bc() = BoundaryCondition::Periodic;
       }
     } else {
       for (std::size_t j = 0; j < ai.ny; j++) {
-        tracks[j].set_exit_track_flux(&tracks[ai.nx + j].entry_flux());
-        tracks[ai.nx + j].set_entry_track_flux(&tracks[j].exit_flux());
+        tracks[j].set_exit_track_flux_offset(
+            tracks[ai.nx + j].entry_flux_offset());
+        tracks[ai.nx + j].set_entry_track_flux_offset(
+            tracks[j].exit_flux_offset());
 
         tracks[j].exit_bc() = BoundaryCondition::Periodic;
         tracks[ai.nx + j].entry_bc() = BoundaryCondition::Periodic;
@@ -1010,16 +2585,20 @@ void MOCDriver::set_periodic_bcs_y() {
 
     if (ai.phi < PI_2) {
       for (std::size_t i = 0; i < ai.nx; i++) {
-        tracks[i].set_exit_track_flux(&tracks[ai.ny + i].entry_flux());
-        tracks[ai.ny + i].set_entry_track_flux(&tracks[i].exit_flux());
+        tracks[i].set_exit_track_flux_offset(
+            tracks[ai.ny + i].entry_flux_offset());
+        tracks[ai.ny + i].set_entry_track_flux_offset(
+            tracks[i].exit_flux_offset());
 
         tracks[i].exit_bc() = BoundaryCondition::Periodic;
         tracks[ai.ny + i].entry_bc() = BoundaryCondition::Periodic;
       }
     } else {
       for (std::size_t i = 0; i < ai.nx; i++) {
-        tracks[i].set_entry_track_flux(&tracks[ai.ny + i].exit_flux());
-        tracks[ai.ny + i].set_exit_track_flux(&tracks[i].entry_flux());
+        tracks[i].set_entry_track_flux_offset(
+            tracks[ai.ny + i].exit_flux_offset());
+        tracks[ai.ny + i].set_exit_track_flux_offset(
+            tracks[i].entry_flux_offset());
 
         tracks[i].entry_bc() = BoundaryCondition::Periodic;
         tracks[ai.ny + i].exit_bc() = BoundaryCondition::Periodic;
@@ -1037,8 +2616,10 @@ void MOCDriver::set_ref_vac_bcs_y_max() {
 
     // Go through intersections on top side
     for (std::uint32_t i = 0; i < ai.nx; i++) {
-      tracks.at(i).set_exit_track_flux(&comp_tracks.at(ai.ny + i).exit_flux());
-      comp_tracks.at(ai.ny + i).set_exit_track_flux(&tracks.at(i).exit_flux());
+      tracks.at(i).set_exit_track_flux_offset(
+          comp_tracks.at(ai.ny + i).exit_flux_offset());
+      comp_tracks.at(ai.ny + i).set_exit_track_flux_offset(
+          tracks.at(i).exit_flux_offset());
 
       tracks.at(i).exit_bc() = this->y_max_bc_;
       comp_tracks.at(ai.ny + i).exit_bc() = this->y_max_bc_;
@@ -1055,10 +2636,10 @@ void MOCDriver::set_ref_vac_bcs_y_min() {
 
     // Go through intersections on bottom side
     for (std::uint32_t i = 0; i < ai.nx; i++) {
-      tracks.at(ai.ny + i).set_entry_track_flux(
-          &comp_tracks.at(i).entry_flux());
-      comp_tracks.at(i).set_entry_track_flux(
-          &tracks.at(ai.ny + i).entry_flux());
+      tracks.at(ai.ny + i).set_entry_track_flux_offset(
+          comp_tracks.at(i).entry_flux_offset());
+      comp_tracks.at(i).set_entry_track_flux_offset(
+          tracks.at(ai.ny + i).entry_flux_offset());
 
       tracks.at(ai.ny + i).entry_bc() = this->y_min_bc_;
       comp_tracks.at(i).entry_bc() = this->y_min_bc_;
@@ -1076,10 +2657,10 @@ void MOCDriver::set_ref_vac_bcs_x_max() {
 
     // Go down right side
     for (std::uint32_t i = 0; i < ai.ny; i++) {
-      tracks.at(ai.nx + i).set_exit_track_flux(
-          &comp_tracks.at(nt - 1 - i).entry_flux());
-      comp_tracks.at(nt - 1 - i)
-          .set_entry_track_flux(&tracks.at(ai.nx + i).exit_flux());
+      tracks.at(ai.nx + i).set_exit_track_flux_offset(
+          comp_tracks.at(nt - 1 - i).entry_flux_offset());
+      comp_tracks.at(nt - 1 - i).set_entry_track_flux_offset(
+          tracks.at(ai.nx + i).exit_flux_offset());
 
       tracks.at(ai.nx + i).exit_bc() = this->x_max_bc_;
       comp_tracks.at(nt - 1 - i).entry_bc() = this->x_max_bc_;
@@ -1097,10 +2678,10 @@ void MOCDriver::set_ref_vac_bcs_x_min() {
     // Go down left side
     // Go down left/right sides
     for (std::uint32_t i = 0; i < ai.ny; i++) {
-      tracks.at(i).set_entry_track_flux(
-          &comp_tracks.at(ai.ny - 1 - i).exit_flux());
-      comp_tracks.at(ai.ny - 1 - i)
-          .set_exit_track_flux(&tracks.at(i).entry_flux());
+      tracks.at(i).set_entry_track_flux_offset(
+          comp_tracks.at(ai.ny - 1 - i).exit_flux_offset());
+      comp_tracks.at(ai.ny - 1 - i).set_exit_track_flux_offset(
+          tracks.at(i).entry_flux_offset());
 
       tracks.at(i).entry_bc() = this->x_min_bc_;
       comp_tracks.at(ai.ny - 1 - i).exit_bc() = this->x_min_bc_;
@@ -1125,10 +2706,19 @@ void MOCDriver::set_bcs() {
 }
 
 void MOCDriver::allocate_track_fluxes() {
+  // All boundary fluxes are held in a single arena, in the order of the
+  // tracks, and each track only keeps the offsets of its two blocks
+  std::size_t ntracks = 0;
+  for (const auto& tracks : tracks_) ntracks += tracks.size();
+  boundary_flux_.resize({ntracks, 2, ngroups_, n_pol_angles_});
+  boundary_flux_.fill(0.);
+
+  const std::size_t block = ngroups_ * n_pol_angles_;
+  std::size_t offset = 0;
   for (auto& tracks : tracks_) {
     for (auto& track : tracks) {
-      track.entry_flux().resize({ngroups_, n_pol_angles_});
-      track.exit_flux().resize({ngroups_, n_pol_angles_});
+      track.set_flux_offsets(offset, offset + block);
+      offset += 2 * block;
     }
   }
 }
@@ -1170,6 +2760,102 @@ void MOCDriver::allocate_fsr_data() {
   for (std::size_t i = 0; i < ninst_prev; i++) {
     fsrs_.push_back(fsr_ptrs[id_prev]);
   }
+
+  // Put the pointers in the internal order if the FSRs were renumbered
+  if (fsr_original_indx_.empty() == false) {
+    std::vector<const FlatSourceRegion*> orig_fsrs = fsrs_;
+    for (std::size_t i = 0; i < nfsrs_; i++) {
+      fsrs_[i] = orig_fsrs[fsr_original_indx_[i]];
+    }
+  }
+}
+
+void MOCDriver::renumber_fsrs_by_tracks() {
+  // FSRs are numbered in the order in which they are first crossed by the
+  // tracks, so that consecutive segments mostly access nearby entries of the
+  // flux and source arrays. FSRs which are not crossed by any track are
+  // placed at the end. An empty order restores the original numbering.
+  // This must be called once the segments have been flattened, while
+  // seg_fsrs_ still holds the original FSR indices.
+  std::vector<std::size_t> order;
+
+  if (renumber_fsrs_ && on_the_fly_tracking_) {
+    spdlog::warn(
+        "Flat source regions are not renumbered with on-the-fly tracking.");
+  } else if (renumber_fsrs_) {
+    std::vector<bool> visited(nfsrs_, false);
+    order.reserve(nfsrs_);
+    for (const auto i : seg_fsrs_) {
+      if (visited[i] == false) {
+        visited[i] = true;
+        order.push_back(i);
+      }
+    }
+
+    for (std::size_t i = 0; i < nfsrs_; i++) {
+      if (visited[i] == false) order.push_back(i);
+    }
+
+    spdlog::info("Renumbering flat source regions in track order");
+  }
+
+  apply_fsr_order(std::move(order));
+
+  if (fsr_internal_indx_.empty() == false) {
+    for (auto& i : seg_fsrs_) {
+      i = static_cast<std::uint32_t>(fsr_internal_indx_[i]);
+    }
+
+    if (seg_scale_.size() > 0) {
+      xt::xtensor<double, 2> new_min(seg_min_.shape());
+      xt::xtensor<double, 2> new_scale(seg_scale_.shape());
+      for (std::size_t a = 0; a < seg_scale_.shape()[0]; a++) {
+        for (std::size_t i = 0; i < nfsrs_; i++) {
+          new_min(a, fsr_internal_indx_[i]) = seg_min_(a, i);
+          new_scale(a, fsr_internal_indx_[i]) = seg_scale_(a, i);
+        }
+      }
+      seg_min_ = std::move(new_min);
+      seg_scale_ = std::move(new_scale);
+    }
+  }
+}
+
+void MOCDriver::apply_fsr_order(std::vector<std::size_t> order) {
+  // The entry order[k] is the original index of the FSR which becomes the
+  // internal FSR k. Data currently stored with the previous numbering is
+  // moved to the new one.
+  const bool identity = order.empty();
+  if (identity) {
+    order.resize(nfsrs_);
+    for (std::size_t i = 0; i < nfsrs_; i++) order[i] = i;
+  }
+
+  std::vector<const FlatSourceRegion*> new_fsrs(nfsrs_, nullptr);
+  xt::xtensor<double, 3> new_flux(flux_.shape());
+  xt::xtensor<double, 2> new_extern_src(extern_src_.shape());
+  for (std::size_t k = 0; k < nfsrs_; k++) {
+    const std::size_t i_old = internal_fsr_indx(order[k]);
+    new_fsrs[k] = fsrs_[i_old];
+    for (std::size_t g = 0; g < flux_.shape()[0]; g++) {
+      for (std::size_t lj = 0; lj < flux_.shape()[2]; lj++) {
+        new_flux(g, k, lj) = flux_(g, i_old, lj);
+      }
+      new_extern_src(g, k) = extern_src_(g, i_old);
+    }
+  }
+  fsrs_ = std::move(new_fsrs);
+  flux_ = std::move(new_flux);
+  extern_src_ = std::move(new_extern_src);
+
+  if (identity) {
+    fsr_internal_indx_.clear();
+    fsr_original_indx_.clear();
+  } else {
+    fsr_internal_indx_.assign(nfsrs_, 0);
+    for (std::size_t k = 0; k < nfsrs_; k++) fsr_internal_indx_[order[k]] = k;
+    fsr_original_indx_ = std::move(order);
+  }
 }
 
 void MOCDriver::segment_renormalization() {
@@ -1180,6 +2866,26 @@ void MOCDriver::segment_renormalization() {
   // could be done for all angles together. A great explanation of this is
   // found in the MPACT theory manual ORNL/SPR-2021/2330 end of 5.4.
 
+  if (on_the_fly_tracking_) {
+    // The approximate volumes were tallied while tracing, and are replaced by
+    // the factors applied to the segments when they are traced again
+    double max_factor = 0.;
+    for (std::size_t a = 0; a < angle_info_.size(); a++) {
+      for (std::size_t i = 0; i < nfsrs_; i++) {
+        const double approx_vol = otf_renorm_(a, i);
+        const double vol = fsrs_[internal_fsr_indx(i)]->volume();
+        otf_renorm_(a, i) = approx_vol > 0. ? vol / approx_vol : 1.;
+        max_factor = std::max(max_factor, otf_renorm_(a, i));
+      }
+    }
+    otf_max_length_ *= max_factor;
+    return;
+  }
+
+  // Quantized lengths are renormalized once they have been quantized, when
+  // the segments are flattened
+  if (segment_encoding_ != SegmentEncoding::Double) return;
+
   // This holds the approximations for the FSR areas
   std::vector<double> approx_vols(nfsrs_, 0.);
 
@@ -1209,6 +2915,554 @@ void MOCDriver::segment_renormalization() {
   }
 }
 
+void MOCDriver::flatten_segments() {
+  // Segment lengths and FSR indices are copied into contiguous arrays, so
+  // that the sweep never has to go through the Segment objects.
+  std::size_t nsegs = 0;
+  for (const auto& tracks : tracks_) {
+    for (const auto& track : tracks) nsegs += track.size();
+  }
+
+  if (nfsrs_ >= std::numeric_limits<std::uint32_t>::max()) {
+    auto mssg = "Number of flat source regions is too large for indexing.";
+    spdlog::error(mssg);
+    throw ScarabeeException(mssg);
+  }
+
+  seg_lengths_.clear();
+  seg_codes16_.clear();
+  seg_codes32_.clear();
+  seg_fsrs_.clear();
+  seg_entry_cmfd_.clear();
+  seg_exit_cmfd_.clear();
+  if (segment_encoding_ == SegmentEncoding::Double) {
+    seg_lengths_.reserve(nsegs);
+  } else if (segment_encoding_ == SegmentEncoding::Quantized16) {
+    seg_codes16_.reserve(nsegs);
+  } else {
+    seg_codes32_.reserve(nsegs);
+  }
+  seg_fsrs_.reserve(nsegs);
+  if (cmfd_) {
+    seg_entry_cmfd_.reserve(nsegs);
+    seg_exit_cmfd_.reserve(nsegs);
+  }
+
+  // With a quantized encoding, the lengths of the segments crossing an FSR
+  // are stored as the shortest of these segments plus a multiple of a step,
+  // which divides the range of their lengths into the available codes
+  const bool quantized = segment_encoding_ != SegmentEncoding::Double;
+  const double max_code = max_segment_code(segment_encoding_);
+  std::vector<double> min_lengths, steps;
+  if (quantized) {
+    min_lengths.assign(nfsrs_, std::numeric_limits<double>::max());
+    steps.assign(nfsrs_, 0.);
+    for (const auto& tracks : tracks_) {
+      for (const auto& track : tracks) {
+        for (const auto& seg : track) {
+          const std::size_t i = seg.fsr_indx();
+          min_lengths[i] = std::min(min_lengths[i], seg.length());
+          steps[i] = std::max(steps[i], seg.length());
+        }
+      }
+    }
+    for (std::size_t i = 0; i < nfsrs_; i++) {
+      if (steps[i] == 0.) min_lengths[i] = 0.;
+      steps[i] = (steps[i] - min_lengths[i]) / max_code;
+    }
+
+    seg_min_ = xt::zeros<double>({tracks_.size(), nfsrs_});
+    seg_scale_ = xt::zeros<double>({tracks_.size(), nfsrs_});
+  } else {
+    seg_min_.resize({0, 0});
+    seg_scale_.resize({0, 0});
+  }
+
+  for (std::size_t a = 0; a < tracks_.size(); a++) {
+    for (auto& track : tracks_[a]) {
+      const std::size_t offset = seg_fsrs_.size();
+
+      for (const auto& seg : track) {
+        const std::size_t i = seg.fsr_indx();
+        seg_fsrs_.push_back(static_cast<std::uint32_t>(i));
+
+        if (quantized) {
+          // The approximate FSR volumes are tallied with the quantized
+          // lengths. All segments of an FSR have the same length when its
+          // step is zero.
+          double code = 0.;
+          if (steps[i] > 0.) {
+            code = std::clamp(
+                std::round((seg.length() - min_lengths[i]) / steps[i]), 0.,
+                max_code);
+          }
+          if (segment_encoding_ == SegmentEncoding::Quantized16) {
+            seg_codes16_.push_back(static_cast<std::uint16_t>(code));
+          } else {
+            seg_codes32_.push_back(static_cast<std::uint32_t>(code));
+          }
+          seg_scale_(a, i) +=
+              (min_lengths[i] + code * steps[i]) * angle_info_[a].d;
+        } else {
+          seg_lengths_.push_back(static_cast<MOCReal>(seg.length()));
+        }
+
+        if (cmfd_) {
+          seg_entry_cmfd_.push_back(
+              seg.entry_cmfd_surface()
+                  ? static_cast<std::uint32_t>(*seg.entry_cmfd_surface())
+                  : NO_CMFD_SURFACE);
+          seg_exit_cmfd_.push_back(
+              seg.exit_cmfd_surface()
+                  ? static_cast<std::uint32_t>(*seg.exit_cmfd_surface())
+                  : NO_CMFD_SURFACE);
+        }
+      }
+
+      track.set_flattened(offset);
+    }
+  }
+
+  if (quantized) {
+    // The renormalization of the quantized lengths is folded into the
+    // minimum lengths and the steps, so that the FSR volumes are preserved
+    // exactly
+    for (std::size_t a = 0; a < tracks_.size(); a++) {
+      for (std::size_t i = 0; i < nfsrs_; i++) {
+        const double approx_vol = seg_scale_(a, i);
+        const double vol = fsrs_[internal_fsr_indx(i)]->volume();
+        const double factor = approx_vol > 0. ? vol / approx_vol : 1.;
+        seg_min_(a, i) = factor * min_lengths[i];
+        seg_scale_(a, i) = factor * steps[i];
+      }
+    }
+  }
+}
+
+void MOCDriver::build_exp_table() {
+  // Find the largest optical thickness which can occur along a segment
+  double max_Et = 0.;
+  for (std::size_t i = 0; i < nfsrs_; i++) {
+    const auto& mat = *fsrs_[i]->xs();
+    for (std::size_t g = 0; g < ngroups_; g++) {
+      max_Et = std::max(max_Et, anisotropic_ ? mat.Et(g) : mat.Etr(g));
+    }
+  }
+
+  double max_l = on_the_fly_tracking_ ? otf_max_length_ : 0.;
+  for (const auto& l : seg_lengths_) {
+    max_l = std::max(max_l, static_cast<double>(l));
+  }
+  if (seg_scale_.size() > 0) {
+    const double max_code = max_segment_code(segment_encoding_);
+    for (std::size_t a = 0; a < seg_scale_.shape()[0]; a++) {
+      for (std::size_t i = 0; i < seg_scale_.shape()[1]; i++) {
+        max_l = std::max(max_l, seg_min_(a, i) + seg_scale_(a, i) * max_code);
+      }
+    }
+  }
+
+  double max_invs_sin = 0.;
+  for (const auto& is : polar_quad_.invs_sin())
+    max_invs_sin = std::max(max_invs_sin, is);
+
+  double max_tau = max_Et * max_l * max_invs_sin;
+  if (max_tau <= 0.) max_tau = 1.;
+
+  exp_table_ = ExpTable(max_tau);
+
+  // Compare the table and the rational approximation on the same points
+  double rational_err = 0.;
+  for (std::size_t i = 0; i < 4 * exp_table_.size(); i++) {
+    const double x = 0.25 * static_cast<double>(i) * exp_table_.dx();
+    rational_err =
+        std::max(rational_err, std::abs(mexp(x) - (1. - std::exp(-x))));
+  }
+
+  spdlog::info("Exponential table: {} points, max optical thickness {:.3f}",
+               exp_table_.size(), max_tau);
+  spdlog::info("Exponential table error bound: {:.3E}",
+               exp_table_.error_bound());
+  spdlog::info("Exponential table max sampled error: {:.3E}",
+               exp_table_.max_error());
+  spdlog::info("Rational exponential max sampled error: {:.3E}", rational_err);
+}
+
+void MOCDriver::pad_polar_quadrature() {
+  // The sweeps process the polar angles in SIMD batches. The quadrature is
+  // therefore copied into aligned arrays, indexed by the polar index of the
+  // sweeps (which includes both hemispheres for anisotropic problems), and
+  // padded with zeros so that the extra lanes leave the fluxes unchanged.
+  constexpr std::size_t W = MOCBatch::size;
+  n_pol_pad_ = W * ((n_pol_angles_ + W - 1) / W);
+
+  if (n_pol_pad_ > MAX_PADDED_POLAR) {
+    auto mssg = "Too many polar angles for the MOC sweep.";
+    spdlog::error(mssg);
+    throw ScarabeeException(mssg);
+  }
+
+  const std::size_t n_quad = polar_quad_.sin().size();
+  pq_invs_sin_.assign(n_pol_pad_, 0.);
+  pq_wsin_.assign(n_pol_pad_, 0.);
+  pq_wgt_.assign(n_pol_pad_, 0.);
+  for (std::size_t pp = 0; pp < n_pol_angles_; pp++) {
+    const std::size_t p = pp % n_quad;
+    pq_invs_sin_[pp] = static_cast<MOCReal>(polar_quad_.invs_sin()[p]);
+    pq_wsin_[pp] = static_cast<MOCReal>(polar_quad_.wsin()[p]);
+    pq_wgt_[pp] = static_cast<MOCReal>(polar_quad_.wgt()[p]);
+  }
+}
+
+void MOCDriver::list_tracks() {
+  track_list_.clear();
+  for (auto& tracks : tracks_) {
+    for (auto& track : tracks) track_list_.push_back(&track);
+  }
+
+  // The cost of sweeping a track is proportional to its number of segments
+  std::vector<double> costs(track_list_.size());
+  for (std::size_t t = 0; t < track_list_.size(); t++) {
+    costs[t] = static_cast<double>(track_list_[t]->num_segments());
+  }
+  track_order_ = longest_first_order(costs);
+
+  // Buffers for the segments of the tracks traced on the fly, or for the
+  // decoded quantized lengths
+  std::size_t max_segs = 0;
+  for (const auto* track : track_list_) {
+    max_segs = std::max(max_segs, track->num_segments());
+  }
+
+  thread_seg_lengths_.clear();
+  thread_seg_fsrs_.clear();
+  if (on_the_fly_tracking_ || segment_encoding_ != SegmentEncoding::Double) {
+    thread_seg_lengths_.resize(max_threads());
+    for (auto& lengths : thread_seg_lengths_) lengths.reserve(max_segs);
+  }
+  if (on_the_fly_tracking_) {
+    thread_seg_fsrs_.resize(max_threads());
+    for (auto& fsrs : thread_seg_fsrs_) fsrs.reserve(max_segs);
+  }
+}
+
+MOCDriver::TrackSegments MOCDriver::track_segments(const Track& track) {
+  if (on_the_fly_tracking_) {
+    auto& lengths = thread_seg_lengths_[thread_num()];
+    auto& fsrs = thread_seg_fsrs_[thread_num()];
+    this->retrace_track(track, lengths, fsrs);
+    return {lengths.data(), fsrs.data(), lengths.size()};
+  }
+
+  const std::size_t offset = track.segment_offset();
+  const std::size_t ns = track.num_segments();
+  const std::uint32_t* fsrs = seg_fsrs_.data() + offset;
+  if (segment_encoding_ == SegmentEncoding::Double) {
+    return {seg_lengths_.data() + offset, fsrs, ns};
+  }
+
+  // Quantized lengths are decoded into the buffer of the thread, which stays
+  // in cache while the track is swept
+  auto& lengths = thread_seg_lengths_[thread_num()];
+  lengths.resize(ns);
+  const double* lmin = &seg_min_(track.phi_index_forward(), 0);
+  const double* scale = &seg_scale_(track.phi_index_forward(), 0);
+  if (segment_encoding_ == SegmentEncoding::Quantized16) {
+    const std::uint16_t* codes = seg_codes16_.data() + offset;
+    for (std::size_t s = 0; s < ns; s++) {
+      const std::uint32_t i = fsrs[s];
+      lengths[s] = static_cast<MOCReal>(lmin[i] + codes[s] * scale[i]);
+    }
+  } else {
+    const std::uint32_t* codes = seg_codes32_.data() + offset;
+    for (std::size_t s = 0; s < ns; s++) {
+      const std::uint32_t i = fsrs[s];
+      lengths[s] = static_cast<MOCReal>(lmin[i] + codes[s] * scale[i]);
+    }
+  }
+  return {lengths.data(), fsrs, ns};
+}
+
+void MOCDriver::retrace_track(const Track& track,
+                              std::vector<MOCReal>& lengths,
+                              std::vector<std::uint32_t>& fsrs) const {
+  // Traces the track again from its entry point, in the same way as
+  // trace_track_segments, but only reading the cached chords. Tiles are
+  // located on the lattice, and the FSRs are only searched for within the
+  // tile when its chord is not cached.
+  lengths.clear();
+  fsrs.clear();
+
+  const std::size_t a = track.phi_index_forward();
+
+  if (otf_chord_refs_.empty() == false) {
+    // Modular laydown, where the segments are copied from the chords
+    for (const ChordRef* ref = &otf_chord_refs_[track.segment_offset()];
+         ref->chord; ref++) {
+      const std::uint32_t* tile_fsrs =
+          otf_tile_fsrs_.data() + otf_tile_offsets_[ref->tile];
+      for (const auto& cs : *ref->chord) {
+        const std::size_t i = tile_fsrs[cs.slot];
+        lengths.push_back(static_cast<MOCReal>(cs.length * otf_renorm_(a, i)));
+        fsrs.push_back(static_cast<std::uint32_t>(internal_fsr_indx(i)));
+      }
+    }
+    return;
+  }
+
+  const ChordMap* chords = otf_chords_.empty() ? nullptr : &otf_chords_[a];
+  const Direction& u = track.dir();
+
+  auto add_segment = [&](const UniqueFSR& ufsr, double l) {
+    const std::size_t i = this->get_fsr_indx(ufsr);
+    lengths.push_back(static_cast<MOCReal>(l * otf_renorm_(a, i)));
+    fsrs.push_back(static_cast<std::uint32_t>(internal_fsr_indx(i)));
+  };
+
+  Vector r = track.entry_pos();
+  auto ti = geometry_->get_tile_index(r, u);
+  while (ti) {
+    const Cartesian2D::TileIndex tile_indx = *ti;
+
+    if (chords) {
+      const auto& tile = geometry_->tile(tile_indx);
+      const void* contents =
+          tile.c2d ? static_cast<const void*>(tile.c2d.get())
+                   : static_cast<const void*>(tile.cell.get());
+      const Vector r_tile = r - geometry_->get_tile_center(tile_indx);
+      const ChordKey key{contents, std::llround(r_tile.x() / CHORD_TOL),
+                         std::llround(r_tile.y() / CHORD_TOL)};
+
+      auto it = chords->find(key);
+      if (it != chords->end()) {
+        for (const auto& cs : it->second) {
+          const UniqueFSR ufsr{
+              cs.fsr, cs.instance + geometry_->fsr_instance_offset(
+                                        tile_indx, cs.fsr->id())};
+          add_segment(ufsr, cs.length);
+          r = r + cs.length * u;
+        }
+
+        ti = geometry_->get_tile_index(r, u);
+        continue;
+      }
+    }
+
+    // Trace the track until it leaves the tile
+    std::pair<UniqueFSR, Vector> fsr_r = geometry_->get_fsr_r_local(r, u);
+    while (ti && ti->i == tile_indx.i && ti->j == tile_indx.j) {
+      if (fsr_r.first.fsr == nullptr) return;
+
+      const double d = fsr_r.first.fsr->distance(fsr_r.second, u);
+      add_segment(fsr_r.first, d);
+      r = r + d * u;
+
+      ti = geometry_->get_tile_index(r, u);
+      if (ti) fsr_r = geometry_->get_fsr_r_local(r, u);
+    }
+  }
+}
+
+void MOCDriver::build_chord_cache() {
+  // Only needed when loading a driver, as the cache holds pointers into the
+  // geometry. Each angle has its own map, so angles are traced in parallel.
+  otf_chords_.clear();
+  otf_chord_refs_.clear();
+  if (modular_tracking_ == false ||
+      geometry_->uniform_tile_size().has_value() == false) {
+    return;
+  }
+
+  otf_chords_.resize(angle_info_.size());
+#pragma omp parallel for schedule(dynamic)
+  for (int ia = 0; ia < static_cast<int>(tracks_.size()); ia++) {
+    const std::size_t a = static_cast<std::size_t>(ia);
+    for (const auto& track : tracks_[a]) {
+      Vector r = track.entry_pos();
+      std::vector<Segment> segments;
+      this->trace_track_segments(r, track.dir(), segments, &otf_chords_[a]);
+    }
+  }
+
+  this->build_chord_refs();
+}
+
+void MOCDriver::build_chord_refs() {
+  // Lists the chords crossed by each track, so that the segments of a track
+  // are assembled from the chords of the tiles it crosses, without any
+  // geometry query. Only the chords are kept for each type of tile, and the
+  // FSR of each tile are found from the slots of the chord segments.
+  otf_chord_refs_.clear();
+  otf_tile_fsrs_.clear();
+  otf_tile_offsets_.clear();
+  if (otf_chords_.empty()) return;
+
+  // Number the FSR instances of each type of tile
+  using FSRInstance = std::pair<const FlatSourceRegion*, std::size_t>;
+  std::map<const void*, std::map<FSRInstance, std::uint32_t>> slots;
+  for (auto& chords : otf_chords_) {
+    for (auto& [key, chord] : chords) {
+      auto& tile_slots = slots[std::get<0>(key)];
+      for (auto& cs : chord) {
+        const auto slot = static_cast<std::uint32_t>(tile_slots.size());
+        cs.slot = tile_slots.try_emplace({cs.fsr, cs.instance}, slot)
+                      .first->second;
+      }
+    }
+  }
+
+  // Original FSR index of each slot, for every tile
+  const std::size_t nx = geometry_->nx();
+  otf_tile_offsets_.resize(nx * geometry_->ny());
+  for (std::size_t j = 0; j < geometry_->ny(); j++) {
+    for (std::size_t i = 0; i < nx; i++) {
+      const Cartesian2D::TileIndex ti{i, j};
+      const auto& tile = geometry_->tile(ti);
+      const void* contents =
+          tile.c2d ? static_cast<const void*>(tile.c2d.get())
+                   : static_cast<const void*>(tile.cell.get());
+      const std::size_t offset = otf_tile_fsrs_.size();
+      otf_tile_offsets_[j * nx + i] = offset;
+
+      auto it = slots.find(contents);
+      if (it == slots.end()) continue;
+      otf_tile_fsrs_.resize(offset + it->second.size());
+      for (const auto& [inst, slot] : it->second) {
+        const UniqueFSR ufsr{
+            inst.first,
+            inst.second + geometry_->fsr_instance_offset(ti, inst.first->id())};
+        otf_tile_fsrs_[offset + slot] =
+            static_cast<std::uint32_t>(this->get_fsr_indx(ufsr));
+      }
+    }
+  }
+
+  // Chords crossed by each track. A chord is only missing where the track
+  // was lost when it was traced.
+  for (auto& tracks : tracks_) {
+    for (auto& track : tracks) {
+      track.set_segment_offset(otf_chord_refs_.size());
+      const ChordMap& chords = otf_chords_[track.phi_index_forward()];
+      const Direction& u = track.dir();
+
+      Vector r = track.entry_pos();
+      auto ti = geometry_->get_tile_index(r, u);
+      while (ti) {
+        const auto& tile = geometry_->tile(*ti);
+        const void* contents =
+            tile.c2d ? static_cast<const void*>(tile.c2d.get())
+                     : static_cast<const void*>(tile.cell.get());
+        const Vector r_tile = r - geometry_->get_tile_center(*ti);
+        const ChordKey key{contents, std::llround(r_tile.x() / CHORD_TOL),
+                           std::llround(r_tile.y() / CHORD_TOL)};
+
+        auto it = chords.find(key);
+        if (it == chords.end()) break;
+        otf_chord_refs_.push_back(
+            {static_cast<std::uint32_t>(ti->j * nx + ti->i), &it->second});
+        for (const auto& cs : it->second) r = r + cs.length * u;
+
+        ti = geometry_->get_tile_index(r, u);
+      }
+
+      otf_chord_refs_.push_back({0, nullptr});
+    }
+  }
+}
+
+TrackingKey MOCDriver::tracking_key(std::uint32_t n_angles, double d) const {
+  // Tracing is done in the plane, so the polar quadrature is not needed
+  return TrackingKey{geometry_->geometry_layout(), n_angles, d,
+                     modular_tracking_, segment_encoding_};
+}
+
+void MOCDriver::fill_total_xs() {
+  // Table of the total xs used along the segments, indexed by group then FSR.
+  // A copy indexed by FSR then group is kept for the group-blocked sweep.
+  Et_.resize({ngroups_, nfsrs_});
+  Et_by_fsr_.resize({nfsrs_, ngroups_});
+  for (std::size_t i = 0; i < nfsrs_; i++) {
+    const auto& mat = *fsrs_[i]->xs();
+    for (std::size_t g = 0; g < ngroups_; g++) {
+      Et_(g, i) = static_cast<MOCReal>(anisotropic_ ? mat.Et(g) : mat.Etr(g));
+      Et_by_fsr_(i, g) = Et_(g, i);
+    }
+  }
+}
+
+void MOCDriver::fill_material_sources() {
+  // FSRs are grouped by material, and the dense scattering matrices of each
+  // material are built once, indexed by outgoing then incoming group.
+  material_sources_.clear();
+  source_blocks_.clear();
+  first_upscatter_group_ = ngroups_;
+  std::map<const CrossSection*, std::size_t> mat_indx;
+  std::vector<std::size_t> open_block;  // Block being filled, by material
+
+  for (std::size_t i = 0; i < nfsrs_; i++) {
+    const CrossSection* xs = fsrs_[i]->xs().get();
+    auto it = mat_indx.find(xs);
+    if (it == mat_indx.end()) {
+      it = mat_indx.emplace(xs, material_sources_.size()).first;
+      open_block.push_back(source_blocks_.size());
+      source_blocks_.push_back({it->second, {}});
+
+      const Eigen::Index NG = static_cast<Eigen::Index>(ngroups_);
+      MaterialSource& ms = material_sources_.emplace_back();
+      ms.fissile = xs->fissile();
+      ms.chi.resize(NG);
+      ms.vEf.resize(NG);
+      for (std::size_t g = 0; g < ngroups_; g++) {
+        ms.chi(static_cast<Eigen::Index>(g)) = xs->chi(g);
+        ms.vEf(static_cast<Eigen::Index>(g)) = xs->vEf(g);
+      }
+
+      const std::size_t nl =
+          anisotropic_ ? std::min(max_L_, xs->max_legendre_order()) + 1 : 1;
+      ms.scatter.resize(nl);
+      for (std::size_t l = 0; l < nl; l++) {
+        ms.scatter[l].resize(NG, NG);
+        for (std::size_t gg = 0; gg < ngroups_; gg++) {
+          for (std::size_t g = 0; g < ngroups_; g++) {
+            ms.scatter[l](static_cast<Eigen::Index>(g),
+                          static_cast<Eigen::Index>(gg)) =
+                anisotropic_ ? xs->Es(l, gg, g) : xs->Es_tr(gg, g);
+          }
+        }
+      }
+
+      // Any scattering from a group gg into a faster group g is upscatter
+      for (std::size_t g = 0; g < first_upscatter_group_; g++) {
+        const Eigen::Index G = static_cast<Eigen::Index>(g);
+        if ((ms.scatter[0].row(G).tail(NG - G - 1).array() != 0.).any()) {
+          first_upscatter_group_ = g;
+          break;
+        }
+      }
+    }
+
+    // Start a new block when the current one of the material is full
+    std::size_t& b = open_block[it->second];
+    if (source_blocks_[b].fsrs.size() == SOURCE_BLOCK_SIZE) {
+      b = source_blocks_.size();
+      source_blocks_.push_back({it->second, {}});
+    }
+    source_blocks_[b].fsrs.push_back(i);
+  }
+
+  // Workspaces for the source evaluation and the Gauss-Seidel fission source,
+  // sized once so that no allocation is made during the iterations
+  const Eigen::Index NG = static_cast<Eigen::Index>(ngroups_);
+  const Eigen::Index NB = static_cast<Eigen::Index>(SOURCE_BLOCK_SIZE);
+  thread_src_work_.resize(max_threads());
+  for (auto& work : thread_src_work_) {
+    work.flux.resize(NG, NB);
+    work.src.resize(NG, NB);
+    work.fiss.resize(NB);
+  }
+  fiss_src_.assign(nfsrs_, 0.);
+}
+
 double MOCDriver::flux(const Vector& r, const Direction& u, std::size_t g,
                        std::size_t lj) const {
   if (g >= ngroups()) {
@@ -1227,7 +3481,7 @@ double MOCDriver::flux(const Vector& r, const Direction& u, std::size_t g,
 
   try {
     const auto& fsr = this->get_fsr(r, u);
-    return flux_(g, get_fsr_indx(fsr), lj);
+    return flux_(g, internal_fsr_indx(get_fsr_indx(fsr)), lj);
   } catch (ScarabeeException& err) {
     std::stringstream mssg;
     mssg << "Could not find flat source region at r = " << r << " u = " << u
@@ -1265,7 +3519,7 @@ double MOCDriver::flux(std::size_t i, std::size_t g, std::size_t lj) const {
     throw ScarabeeException(mssg.str());
   }
 
-  return flux_(g, i, lj);
+  return flux_(g, internal_fsr_indx(i), lj);
 }
 
 double MOCDriver::volume(const Vector& r, const Direction& u) const {
@@ -1295,7 +3549,7 @@ double MOCDriver::volume(std::size_t i) const {
     throw ScarabeeException(mssg.str());
   }
 
-  return fsrs_[i]->volume();
+  return fsrs_[internal_fsr_indx(i)]->volume();
 }
 
 const std::shared_ptr<CrossSection>& MOCDriver::xs(const Vector& r,
@@ -1322,7 +3576,7 @@ const std::shared_ptr<CrossSection>& MOCDriver::xs(std::size_t i) const {
     throw ScarabeeException(mssg.str());
   }
 
-  return fsrs_[i]->xs();
+  return fsrs_[internal_fsr_indx(i)]->xs();
 }
 
 UniqueFSR MOCDriver::get_fsr(const Vector& r, const Direction& u) const {
@@ -1378,7 +3632,7 @@ void MOCDriver::set_extern_src(const Vector& r, const Direction& u,
     throw ScarabeeException(mssg);
   }
 
-  extern_src_(g, i) = src;
+  extern_src_(g, internal_fsr_indx(i)) = src;
 }
 
 double MOCDriver::extern_src(const Vector& r, const Direction& u,
@@ -1397,7 +3651,7 @@ double MOCDriver::extern_src(const Vector& r, const Direction& u,
     throw ScarabeeException(mssg);
   }
 
-  return extern_src_(g, i);
+  return extern_src_(g, internal_fsr_indx(i));
 }
 
 void MOCDriver::set_extern_src(std::size_t i, std::size_t g, double src) {
@@ -1419,7 +3673,7 @@ void MOCDriver::set_extern_src(std::size_t i, std::size_t g, double src) {
     throw ScarabeeException(mssg);
   }
 
-  extern_src_(g, i) = src;
+  extern_src_(g, internal_fsr_indx(i)) = src;
 }
 
 double MOCDriver::extern_src(std::size_t i, std::size_t g) const {
@@ -1435,7 +3689,7 @@ double MOCDriver::extern_src(std::size_t i, std::size_t g) const {
     throw ScarabeeException(mssg);
   }
 
-  return extern_src_(g, i);
+  return extern_src_(g, internal_fsr_indx(i));
 }
 
 std::shared_ptr<CrossSection> MOCDriver::homogenize() const {
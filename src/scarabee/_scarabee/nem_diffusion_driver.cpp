@@ -2,15 +2,18 @@
 #include <utils/logging.hpp>
 #include <utils/scarabee_exception.hpp>
 #include <utils/timer.hpp>
+#include <utils/chebyshev_acceleration.hpp>
 #include <utils/constants.hpp>
 
 #include <cereal/archives/portable_binary.hpp>
 
+#include <algorithm>
 #include <array>
 #include <cmath>
 #include <cstdarg>
 #include <fstream>
 #include <optional>
+#include <utility>
 
 namespace scarabee {
 
@@ -726,21 +729,40 @@ void NEMDiffusionDriver::solve() {
   double flux_diff = 100.;
   std::size_t iteration = 0;
   Timer iteration_timer;
+  ChebyshevAcceleration chebyshev;
+  // The partial currents are carried from one outer iteration to the next,
+  // so they are part of the extrapolated iterate along with the flux moments
+  xt::xtensor<Current, 3> old_j_in_out;
+  if (chebyshev_acceleration_) old_j_in_out = j_in_out_;
+  static_assert(sizeof(Current) == 6 * sizeof(double));
   while (keff_diff > keff_tol_ || flux_diff > flux_tol_) {
     iteration_timer.reset();
     iteration_timer.start();
     iteration++;
 
-    // Copy current flux into old flux
-    old_flux = flux_;
-
     // Calculating the source
     fill_source();
 
+    // The inner iterations overwrite every flux moment of every node, so the
+    // current flux only needs to be swapped into old_flux instead of copied
+    std::swap(old_flux, flux_);
+    if (chebyshev_acceleration_) {
+      std::copy(j_in_out_.begin(), j_in_out_.end(), old_j_in_out.begin());
+    }
+
     // Perform 2 inner iterations per outer generation
     inner_iteration();
     inner_iteration();
 
+    // Extrapolate the node flux moments, which determine the next source,
+    // and the partial currents, which start the next inner iterations
+    if (chebyshev_acceleration_) {
+      const std::size_t nj = 6 * j_in_out_.size();
+      chebyshev.extrapolate<double>(
+          {old_flux.data(), old_flux.size()}, {flux_.data(), flux_.size()},
+          {old_j_in_out.data()->data(), nj}, {j_in_out_.data()->data(), nj});
+    }
+
     // Compute new keff
     double prev_keff = keff_;
     keff_ = calc_keff(prev_keff, old_flux, flux_);
@@ -760,6 +782,7 @@ void NEMDiffusionDriver::solve() {
   }
 
   solved_ = true;
+  iterations_ = iteration;
 
   sim_timer.stop();
   spdlog::info("");
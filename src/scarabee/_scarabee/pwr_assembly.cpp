@@ -10,8 +10,10 @@
 
 #include <cereal/archives/portable_binary.hpp>
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
+#include <iterator>
 #include <sstream>
 
 namespace scarabee {
@@ -227,8 +229,7 @@ void PWRAssembly::solve() {
     throw ScarabeeException(mssg);
   }
 
-  get_fuel_dancoff_corrections();
-  get_clad_dancoff_corrections();
+  get_dancoff_corrections();
   pin_cell_calc();
   condense_xs();
   moc_calc();
@@ -238,17 +239,85 @@ void PWRAssembly::solve() {
   compute_adf_cdf();
 }
 
-double PWRAssembly::isolated_fuel_pin_flux(DancoffMaterial dm) const {
+// Material which is black in each group of the batched Dancoff problems, in
+// the order of FUEL_DANCOFF_GROUP and CLAD_DANCOFF_GROUP
+const std::vector<std::string> DANCOFF_BLACK_MATERIALS{"Fuel", "Clad"};
+
+// Cross section whose groups hold the one-group cross sections of several
+// Dancoff problems. There is no scattering between the groups, so that each
+// group remains an independent fixed-source problem.
+inline std::shared_ptr<CrossSection> batch_dancoff_xs(
+    const std::vector<std::shared_ptr<CrossSection>>& xs) {
+  const std::size_t n = xs.size();
+  xt::xtensor<double, 1> Et = xt::zeros<double>({n});
+  xt::xtensor<double, 1> Ea = xt::zeros<double>({n});
+  xt::xtensor<double, 2> Es = xt::zeros<double>({n, n});
+  for (std::size_t g = 0; g < n; g++) {
+    Et(g) = xs[g]->Etr(0);
+    Ea(g) = xs[g]->Ea(0);
+    Es(g, g) = xs[g]->Es_tr(0, 0);
+  }
+  return std::make_shared<CrossSection>(Et, Ea, Es, xs.front()->name());
+}
+
+// Pin cell with the geometry shared by the Dancoff cells, whose group g
+// holds the cross sections of cells[g]
+inline std::shared_ptr<SimplePinCell> batch_dancoff_cells(
+    const std::vector<std::shared_ptr<SimplePinCell>>& cells) {
+  const SimplePinCell& front = *cells.front();
+  std::vector<std::shared_ptr<CrossSection>> mats;
+  mats.reserve(front.materials().size());
+  for (std::size_t m = 0; m < front.materials().size(); m++) {
+    std::vector<std::shared_ptr<CrossSection>> xs;
+    xs.reserve(cells.size());
+    for (const auto& cell : cells) xs.push_back(cell->materials()[m]);
+    mats.push_back(batch_dancoff_xs(xs));
+  }
+
+  return std::make_shared<SimplePinCell>(front.radii(), mats, front.dx(),
+                                         front.dy(), front.pin_type());
+}
+
+// Sets the source of group g to the potential xs (should be Et) in all
+// materials but black_mats[g]
+inline void set_dancoff_sources(MOCDriver& moc,
+                                const std::vector<std::string>& black_mats) {
+  for (std::size_t i = 0; i < moc.nfsr(); i++) {
+    const auto& i_xs = moc.xs(i);
+    for (std::size_t g = 0; g < black_mats.size(); g++) {
+      if (i_xs->name() != black_mats[g]) {
+        moc.set_extern_src(i, g, i_xs->Et(g));
+      }
+    }
+  }
+}
+
+// Flux of group g in the first FSR filled with material black_mats[g]
+inline std::vector<double> black_material_fluxes(
+    const MOCDriver& moc, const std::vector<std::string>& black_mats) {
+  std::vector<double> fluxes(black_mats.size(), 0.);
+  for (std::size_t g = 0; g < black_mats.size(); g++) {
+    for (std::size_t i = 0; i < moc.nfsr(); i++) {
+      if (moc.xs(i)->name() == black_mats[g]) {
+        fluxes[g] = moc.flux(i, g);
+        break;
+      }
+    }
+  }
+  return fluxes;
+}
+
+std::vector<double> PWRAssembly::isolated_fuel_pin_fluxes() const {
   // We first make the system for an isolated fuel pin.
-  // We isolate it by multiplying the pitch by 20.
+  // We isolate it by multiplying the pitch by 20. The fuel and clad
+  // problems are solved together, as the two groups of the same problem.
   std::shared_ptr<SimplePinCell> isolated_fp{nullptr};
   for (const auto& pin : pins_) {
     if (std::holds_alternative<std::shared_ptr<FuelPin>>(pin)) {
       auto ptr = std::get<std::shared_ptr<FuelPin>>(pin);
-      if (dm == DancoffMaterial::Fuel)
-        isolated_fp = ptr->make_fuel_dancoff_cell(20. * pitch_, moderator_);
-      else
-        isolated_fp = ptr->make_clad_dancoff_cell(20. * pitch_, moderator_);
+      isolated_fp = batch_dancoff_cells(
+          {ptr->make_fuel_dancoff_cell(20. * pitch_, moderator_),
+           ptr->make_clad_dancoff_cell(20. * pitch_, moderator_)});
       break;
     }
   }
@@ -263,23 +332,14 @@ double PWRAssembly::isolated_fuel_pin_flux(DancoffMaterial dm) const {
       std::vector<double>{20. * pitch_}, std::vector<double>{20. * pitch_});
   iso_geom->set_tiles({isolated_fp});
   std::shared_ptr<MOCDriver> iso_moc = std::make_shared<MOCDriver>(iso_geom);
+  iso_moc->set_use_tracking_cache(true);
 
   // Set the source
-  std::string mat_name;
-  if (dm == DancoffMaterial::Fuel)
-    mat_name = "Fuel";
-  else
-    mat_name = "Clad";
-  for (std::size_t i = 0; i < iso_moc->nfsr(); i++) {
-    const auto& i_xs = iso_moc->xs(i);
-    if (i_xs->name() != mat_name) {
-      // If we aren't in the fuel, set the source to be the value of
-      // the potential xs (should be Et).
-      iso_moc->set_extern_src(i, 0, i_xs->Et(0));
-    }
-  }
+  set_dancoff_sources(*iso_moc, DANCOFF_BLACK_MATERIALS);
 
-  // Solve the isolated pin problem
+  // Solve the isolated pin problem, sweeping both groups in a single pass
+  // over the tracks. The groups do not interact, so each one goes through
+  // the same iterates as a separate one-group problem, until both converge.
   iso_moc->x_min_bc() = BoundaryCondition::Vacuum;
   iso_moc->x_max_bc() = BoundaryCondition::Vacuum;
   iso_moc->y_min_bc() = BoundaryCondition::Vacuum;
@@ -287,20 +347,12 @@ double PWRAssembly::isolated_fuel_pin_flux(DancoffMaterial dm) const {
   iso_moc->generate_tracks(dancoff_num_azimuthal_angles_,
                            dancoff_track_spacing_, dancoff_polar_quadrature_);
   iso_moc->sim_mode() = SimulationMode::FixedSource;
+  iso_moc->set_group_block_size(iso_moc->ngroups());
   iso_moc->set_flux_tolerance(1.0e-5);
   iso_moc->solve();
 
-  // Obtain isolated flux
-  double iso_flux = 0.;
-  for (std::size_t i = 0; i < iso_moc->nfsr(); i++) {
-    const auto& i_xs = iso_moc->xs(i);
-    if (i_xs->name() == mat_name) {
-      iso_flux = iso_moc->flux(i, 0);
-      break;
-    }
-  }
-
-  return iso_flux;
+  // Obtain isolated fluxes
+  return black_material_fluxes(*iso_moc, DANCOFF_BLACK_MATERIALS);
 }
 
 double PWRAssembly::isolated_guide_tube_flux() const {
@@ -323,16 +375,10 @@ double PWRAssembly::isolated_guide_tube_flux() const {
       std::vector<double>{20. * pitch_}, std::vector<double>{20. * pitch_});
   iso_geom->set_tiles({isolated_gt});
   std::shared_ptr<MOCDriver> iso_moc = std::make_shared<MOCDriver>(iso_geom);
+  iso_moc->set_use_tracking_cache(true);
 
   // Set the source
-  for (std::size_t i = 0; i < iso_moc->nfsr(); i++) {
-    const auto& i_xs = iso_moc->xs(i);
-    if (i_xs->name() != "Clad") {
-      // If we aren't in the fuel, set the source to be the value of
-      // the potential xs (should be Et).
-      iso_moc->set_extern_src(i, 0, i_xs->Et(0));
-    }
-  }
+  set_dancoff_sources(*iso_moc, {"Clad"});
 
   // Solve the isolated pin problem
   iso_moc->x_min_bc() = BoundaryCondition::Vacuum;
@@ -346,16 +392,7 @@ double PWRAssembly::isolated_guide_tube_flux() const {
   iso_moc->solve();
 
   // Obtain isolated flux
-  double iso_flux = 0.;
-  for (std::size_t i = 0; i < iso_moc->nfsr(); i++) {
-    const auto& i_xs = iso_moc->xs(i);
-    if (i_xs->name() == "Clad") {
-      iso_flux = iso_moc->flux(i, 0);
-      break;
-    }
-  }
-
-  return iso_flux;
+  return black_material_fluxes(*iso_moc, {"Clad"}).front();
 }
 
 double PWRAssembly::isolated_burnable_poison_tube_flux() const {
@@ -378,16 +415,10 @@ double PWRAssembly::isolated_burnable_poison_tube_flux() const {
       std::vector<double>{20. * pitch_}, std::vector<double>{20. * pitch_});
   iso_geom->set_tiles({isolated_bp});
   std::shared_ptr<MOCDriver> iso_moc = std::make_shared<MOCDriver>(iso_geom);
+  iso_moc->set_use_tracking_cache(true);
 
   // Set the source
-  for (std::size_t i = 0; i < iso_moc->nfsr(); i++) {
-    const auto& i_xs = iso_moc->xs(i);
-    if (i_xs->name() != "Clad") {
-      // If we aren't in the fuel, set the source to be the value of
-      // the potential xs (should be Et).
-      iso_moc->set_extern_src(i, 0, i_xs->Et(0));
-    }
-  }
+  set_dancoff_sources(*iso_moc, {"Clad"});
 
   // Solve the isolated pin problem
   iso_moc->x_min_bc() = BoundaryCondition::Vacuum;
@@ -401,122 +432,45 @@ double PWRAssembly::isolated_burnable_poison_tube_flux() const {
   iso_moc->solve();
 
   // Obtain isolated flux
-  double iso_flux = 0.;
-  for (std::size_t i = 0; i < iso_moc->nfsr(); i++) {
-    const auto& i_xs = iso_moc->xs(i);
-    if (i_xs->name() == "Clad") {
-      iso_flux = iso_moc->flux(i, 0);
-      break;
-    }
-  }
-
-  return iso_flux;
-}
-
-void PWRAssembly::get_fuel_dancoff_corrections() {
-  spdlog::info("");
-  spdlog::info("Computing Dancoff factors for fuel");
-  set_logging_level(LogLevel::warn);
-
-  // First get the flux of the isolated pin
-  const double iso_flux = isolated_fuel_pin_flux(DancoffMaterial::Fuel);
-
-  // Now we setup the lattice problem
-  std::vector<Cartesian2D::TileFill> fuel_df_pins;
-  fuel_df_pins.reserve(pins_.size());
-  for (const auto& pin : pins_) {
-    fuel_df_pins.push_back(std::visit(
-        [this](const auto& P) {
-          return P->make_fuel_dancoff_cell(pitch_, moderator_);
-        },
-        pin));
-  }
-  std::shared_ptr<Cartesian2D> geom =
-      std::make_shared<Cartesian2D>(std::vector<double>(shape_.first, pitch_),
-                                    std::vector<double>(shape_.first, pitch_));
-  geom->set_tiles(fuel_df_pins);
-  std::shared_ptr<MOCDriver> moc = std::make_shared<MOCDriver>(geom);
-
-  // Set the source
-  for (std::size_t i = 0; i < moc->nfsr(); i++) {
-    const auto& i_xs = moc->xs(i);
-    if (i_xs->name() != "Fuel") {
-      // If we aren't in the fuel, set the source to be the value of
-      // the potential xs (should be Et).
-      moc->set_extern_src(i, 0, i_xs->Et(0));
-    }
-  }
-
-  // Solve the lattice problem
-  moc->x_min_bc() = this->boundary_conditions();
-  moc->x_max_bc() = this->boundary_conditions();
-  moc->y_min_bc() = this->boundary_conditions();
-  moc->y_max_bc() = this->boundary_conditions();
-  moc->generate_tracks(dancoff_num_azimuthal_angles_, dancoff_track_spacing_,
-                       dancoff_polar_quadrature_);
-  moc->sim_mode() = SimulationMode::FixedSource;
-  moc->set_flux_tolerance(1.0e-5);
-  moc->solve();
-
-  // Now we need to calculate the dancoff correction for each pin
-  fuel_dancoff_corrections_.reserve(pins_.size());
-  const Direction u(1.0, 0.0);
-  for (std::size_t j = 0; j < shape_.second; j++) {
-    const double y = moc->y_max() - (static_cast<double>(j) + 0.5) * pitch_;
-    for (std::size_t i = 0; i < shape_.first; i++) {
-      const double x = moc->x_min() + (static_cast<double>(i) + 0.5) * pitch_;
-      const Vector r(x, y);
-      const auto& xs = moc->xs(r, u);
-      if (xs->name() == "Fuel") {
-        const double flux = moc->flux(r, u, 0);
-        const double C = (iso_flux - flux) / iso_flux;
-        fuel_dancoff_corrections_.push_back(C);
-      } else {
-        fuel_dancoff_corrections_.push_back(0.);
-      }
-    }
-  }
-
-  set_logging_level(LogLevel::info);
+  return black_material_fluxes(*iso_moc, {"Clad"}).front();
 }
 
-void PWRAssembly::get_clad_dancoff_corrections() {
+void PWRAssembly::get_dancoff_corrections() {
   spdlog::info("");
-  spdlog::info("Computing Dancoff factors for cladding");
+  spdlog::info("Computing Dancoff factors for fuel and cladding");
   set_logging_level(LogLevel::warn);
 
-  // obtain isolated fluxes
-  const double iso_flux_fp = isolated_fuel_pin_flux(DancoffMaterial::Clad);
+  // First get the fluxes of the isolated pins
+  const std::vector<double> iso_flux_fp = isolated_fuel_pin_fluxes();
   const double iso_flux_gt = isolated_guide_tube_flux();
   const double iso_flux_bp = isolated_burnable_poison_tube_flux();
 
-  // Now we setup the lattice problem
-  std::vector<Cartesian2D::TileFill> fuel_df_pins;
-  fuel_df_pins.reserve(pins_.size());
+  // Now we setup the lattice problem. The fuel and clad problems share the
+  // same geometry, and are solved together as the two groups of the problem.
+  std::vector<Cartesian2D::TileFill> df_pins;
+  df_pins.reserve(pins_.size());
   for (const auto& pin : pins_) {
-    fuel_df_pins.push_back(std::visit(
+    df_pins.push_back(std::visit(
         [this](const auto& P) {
-          return P->make_clad_dancoff_cell(pitch_, moderator_);
+          return batch_dancoff_cells(
+              {P->make_fuel_dancoff_cell(pitch_, moderator_),
+               P->make_clad_dancoff_cell(pitch_, moderator_)});
         },
         pin));
   }
   std::shared_ptr<Cartesian2D> geom =
       std::make_shared<Cartesian2D>(std::vector<double>(shape_.first, pitch_),
                                     std::vector<double>(shape_.first, pitch_));
-  geom->set_tiles(fuel_df_pins);
+  geom->set_tiles(df_pins);
   std::shared_ptr<MOCDriver> moc = std::make_shared<MOCDriver>(geom);
+  moc->set_use_tracking_cache(true);
+  moc->set_modular_tracking(dancoff_modular_tracking_);
 
   // Set the source
-  for (std::size_t i = 0; i < moc->nfsr(); i++) {
-    const auto& i_xs = moc->xs(i);
-    if (i_xs->name() != "Clad") {
-      // If we aren't in the fuel, set the source to be the value of
-      // the potential xs (should be Et).
-      moc->set_extern_src(i, 0, i_xs->Et(0));
-    }
-  }
+  set_dancoff_sources(*moc, DANCOFF_BLACK_MATERIALS);
 
-  // Solve the lattice problem
+  // Solve the lattice problem, sweeping both groups in a single pass over
+  // the tracks, with the same iterates as separate one-group problems
   moc->x_min_bc() = this->boundary_conditions();
   moc->x_max_bc() = this->boundary_conditions();
   moc->y_min_bc() = this->boundary_conditions();
@@ -524,10 +478,12 @@ void PWRAssembly::get_clad_dancoff_corrections() {
   moc->generate_tracks(dancoff_num_azimuthal_angles_, dancoff_track_spacing_,
                        dancoff_polar_quadrature_);
   moc->sim_mode() = SimulationMode::FixedSource;
+  moc->set_group_block_size(moc->ngroups());
   moc->set_flux_tolerance(1.0e-5);
   moc->solve();
 
-  // Now we need to calculate the dancoff correction for each pin
+  // Now we need to calculate the dancoff corrections for each pin
+  fuel_dancoff_corrections_.reserve(pins_.size());
   clad_dancoff_corrections_.reserve(pins_.size());
   const Direction u(1.0, 0.0);
   std::size_t i_pin = 0;
@@ -536,16 +492,29 @@ void PWRAssembly::get_clad_dancoff_corrections() {
     for (std::size_t i = 0; i < shape_.first; i++) {
       const double x = moc->x_min() + (static_cast<double>(i) + 0.5) * pitch_;
       const auto& pin = pins_[i_pin];
-      const Vector r =
+
+      // Fuel Dancoff correction, at the center of the pin
+      const Vector r_fuel(x, y);
+      if (moc->xs(r_fuel, u)->name() == "Fuel") {
+        const double flux = moc->flux(r_fuel, u, FUEL_DANCOFF_GROUP);
+        const double iso_flux = iso_flux_fp[FUEL_DANCOFF_GROUP];
+        fuel_dancoff_corrections_.push_back((iso_flux - flux) / iso_flux);
+      } else {
+        fuel_dancoff_corrections_.push_back(0.);
+      }
+
+      // Clad Dancoff correction, in the cladding of the pin
+      const Vector r_clad =
           Vector(x, y) +
           std::visit([](const auto& P) { return P->clad_offset(); }, pin);
-      const auto& xs = moc->xs(r, u);
-      const double flux = moc->flux(r, u, 0);
+      const auto& xs = moc->xs(r_clad, u);
+      const double flux = moc->flux(r_clad, u, CLAD_DANCOFF_GROUP);
 
       double C = 0.;
       if (xs->name() == "Clad") {
         if (std::holds_alternative<std::shared_ptr<FuelPin>>(pin)) {
-          C = (iso_flux_fp - flux) / iso_flux_fp;
+          const double iso_flux = iso_flux_fp[CLAD_DANCOFF_GROUP];
+          C = (iso_flux - flux) / iso_flux;
         } else if (std::holds_alternative<std::shared_ptr<GuideTube>>(pin)) {
           C = (iso_flux_gt - flux) / iso_flux_gt;
         } else if (std::holds_alternative<std::shared_ptr<BurnablePoisonPin>>(
@@ -713,13 +682,72 @@ void PWRAssembly::moc_calc() {
     guiplotter.push_layer(std::make_unique<MOCPlotter>(moc_.get()));
     guiplotter.run();
   }
+  if (use_cmfd_) {
+    moc_->set_cmfd(
+        std::make_shared<CMFD>(dx, dy, few_group_condensation_scheme_));
+  }
   moc_->generate_tracks(num_azimuthal_angles_, track_spacing_,
                         polar_quadrature_);
   moc_->set_keff_tolerance(keff_tolerance_);
   moc_->set_flux_tolerance(flux_tolerance_);
+  if (warm_start_moc_) {
+    if (anisotropic_) {
+      spdlog::warn("The MOC is only seeded with isotropic scattering.");
+    } else {
+      seed_moc_flux();
+    }
+  }
   moc_->solve();
 }
 
+void PWRAssembly::seed_moc_flux() {
+  // The MOC cells are filled with the condensed cross sections of the
+  // regions of the pin cell calculations. Each FSR is therefore seeded with
+  // the flux of the matching region, condensed to the macrogroups, and keff
+  // with the mean of the fuel pin cells.
+  const std::size_t NG = moc_->ngroups();
+  xt::xtensor<double, 2> flux = xt::zeros<double>({NG, moc_->nfsr()});
+  double keff_sum = 0.;
+  std::size_t n_fuel = 0;
+
+  const Direction u(1., 0.);
+  std::size_t i_pin = 0;
+  for (std::size_t j = 0; j < shape_.second; j++) {
+    const double y = moc_->y_max() - (static_cast<double>(j) + 0.5) * pitch_;
+    for (std::size_t i = 0; i < shape_.first; i++) {
+      const double x = moc_->x_min() + (static_cast<double>(i) + 0.5) * pitch_;
+      const auto& pin = pins_[i_pin];
+      const auto& cell_flux = pin_1d_fluxes[i_pin];
+      const auto& condensed = std::visit(
+          [](const auto& P) -> const auto& { return P->condensed_xs(); }, pin);
+
+      for (const auto fi : moc_->get_all_fsr_in_cell(Vector(x, y), u)) {
+        const auto it =
+            std::find(condensed.begin(), condensed.end(), moc_->xs(fi));
+        if (it == condensed.end()) continue;
+        const std::size_t r =
+            static_cast<std::size_t>(std::distance(condensed.begin(), it));
+
+        for (std::size_t G = 0; G < NG; G++) {
+          const auto [g_min, g_max] = condensation_scheme_[G];
+          for (std::size_t g = g_min; g <= g_max; g++) {
+            flux(G, fi) += cell_flux->flux(r, g);
+          }
+        }
+      }
+
+      if (std::holds_alternative<std::shared_ptr<FuelPin>>(pin)) {
+        keff_sum += cell_flux->keff();
+        n_fuel++;
+      }
+      i_pin++;
+    }
+  }
+
+  const double keff = n_fuel > 0 ? keff_sum / static_cast<double>(n_fuel) : 1.;
+  moc_->set_initial_flux(flux, keff);
+}
+
 void PWRAssembly::criticality_spectrum() {
   if (criticality_spectrum_method_.has_value() == false) {
     return;
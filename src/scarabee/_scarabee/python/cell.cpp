@@ -1,8 +1,10 @@
 #include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
 
 #include <moc/cell.hpp>
 
 #include <memory>
+#include <optional>
 
 namespace py = pybind11;
 
@@ -40,6 +42,40 @@ void init_Cell(py::module& m) {
            "     Distance that can be traveled.\n",
            py::arg("r"), py::arg("u"))
 
+      .def(
+          "get_fsr_id",
+          [](const Cell& cell, const Vector& r,
+             const Direction& u) -> std::optional<std::size_t> {
+            const UniqueFSR fsr = cell.get_fsr(r, u);
+            if (fsr.fsr == nullptr) return std::nullopt;
+            return fsr.fsr->id();
+          },
+          "Finds the flat source region of a position - direction pair.\n\n"
+          "Parameters\n"
+          "----------\n"
+          "r : Vector\n"
+          "    Position to locate.\n"
+          "u : Direction\n"
+          "    Direction vector for disambiguating a the region.\n\n"
+          "Returns\n"
+          "-------\n"
+          "int or None\n"
+          "     ID of the flat source region, or None if r and u are not in "
+          "the cell.\n",
+          py::arg("r"), py::arg("u"))
+
+      // Test hook, which finds the flat source region by testing every region
+      // of the cell in turn, to check the lookup of get_fsr_id against it.
+      // It is not part of the public API.
+      .def(
+          "_search_fsr_id",
+          [](const Cell& cell, const Vector& r,
+             const Direction& u) -> std::optional<std::size_t> {
+            if (cell.inside(r, u) == false) return std::nullopt;
+            return cell.search_fsr(r, u).fsr->id();
+          },
+          py::arg("r"), py::arg("u"))
+
       .def_property_readonly("dx", &Cell::dx, "Width of cell along x.")
 
       .def_property_readonly("dy", &Cell::dy, "Width of cell along y.");
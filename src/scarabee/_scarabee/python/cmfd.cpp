@@ -0,0 +1,85 @@
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include <moc/cmfd.hpp>
+
+namespace py = pybind11;
+
+using namespace scarabee;
+
+void init_CMFD(py::module& m) {
+  py::class_<CMFD, std::shared_ptr<CMFD>>(
+      m, "CMFD",
+      "A CMFD (Coarse Mesh Finite Difference) mesh is used to accelerate the "
+      "convergence of a :py:class:`MOCDriver` keff calculation. The mesh must "
+      "cover the entire MOC geometry, and its boundaries must align with the "
+      "boundaries of the flat source regions.")
+
+      .def(py::init<const std::vector<double>& /*dx*/,
+                    const std::vector<double>& /*dy*/,
+                    const std::vector<std::pair<std::size_t, std::size_t>>&
+                    /*groups*/>(),
+           "Creates a CMFD mesh. The mesh is centered at the origin, as is "
+           "the case for :py:class:`Cartesian2D`.\n\n"
+           "Parameters\n"
+           "----------\n"
+           "dx : list of float\n"
+           "     Widths of the mesh tiles along the x axis.\n"
+           "dy : list of float\n"
+           "     Widths of the mesh tiles along the y axis.\n"
+           "groups : list of tuple of int\n"
+           "         Energy condensation scheme from the MOC groups to the "
+           "CMFD groups. Each tuple contains the first and last MOC group of a "
+           "CMFD group.",
+           py::arg("dx"), py::arg("dy"), py::arg("groups"))
+
+      .def_property_readonly("nx", &CMFD::nx,
+                             "Number of mesh tiles along the x axis.")
+
+      .def_property_readonly("ny", &CMFD::ny,
+                             "Number of mesh tiles along the y axis.")
+
+      .def_property_readonly("ngroups", &CMFD::ngroups,
+                             "Number of CMFD energy groups.")
+
+      .def_property_readonly("group_condensation", &CMFD::group_condensation,
+                             "Energy condensation scheme.")
+
+      .def_property(
+          "keff_tolerance", &CMFD::keff_tolerance, &CMFD::set_keff_tolerance,
+          "Maximum relative difference in keff for the coarse problem.")
+
+      .def_property(
+          "flux_tolerance", &CMFD::flux_tolerance, &CMFD::set_flux_tolerance,
+          "Maximum relative difference in flux for the coarse problem.")
+
+      .def("flux", &CMFD::flux,
+           "Returns the coarse flux from the most recent CMFD solution.\n\n"
+           "Parameters\n"
+           "----------\n"
+           "i : int\n"
+           "    Tile index along the x axis.\n"
+           "j : int\n"
+           "    Tile index along the y axis.\n"
+           "g : int\n"
+           "    CMFD group index.\n\n"
+           "Returns\n"
+           "-------\n"
+           "float\n"
+           "     Flux in the tile.",
+           py::arg("i"), py::arg("j"), py::arg("g"))
+
+      .def("fsrs", &CMFD::fsrs,
+           "Returns the indices of the flat source regions in a tile.\n\n"
+           "Parameters\n"
+           "----------\n"
+           "i : int\n"
+           "    Tile index along the x axis.\n"
+           "j : int\n"
+           "    Tile index along the y axis.\n\n"
+           "Returns\n"
+           "-------\n"
+           "list of int\n"
+           "     Flat source region indices.",
+           py::arg("i"), py::arg("j"));
+}
@@ -79,6 +79,13 @@ void init_CylindricalFluxSolver(py::module& m) {
                     &CylindricalFluxSolver::set_keff_tolerance,
                     "Tolerance for keff convergence.")
 
+      .def_property("chebyshev_acceleration",
+                    &CylindricalFluxSolver::chebyshev_acceleration,
+                    &CylindricalFluxSolver::set_chebyshev_acceleration,
+                    "If True, the outer generations of a keff calculation are "
+                    "accelerated with Chebyshev extrapolation of the flux. "
+                    "Default is False.")
+
       .def_property("albedo", &CylindricalFluxSolver::albedo,
                     &CylindricalFluxSolver::set_albedo,
                     "Albedo for outer cell boundary.")
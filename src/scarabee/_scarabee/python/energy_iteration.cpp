@@ -0,0 +1,13 @@
+#include <pybind11/pybind11.h>
+
+#include <moc/energy_iteration.hpp>
+
+namespace py = pybind11;
+
+using namespace scarabee;
+
+void init_EnergyIteration(py::module& m) {
+  py::enum_<EnergyIteration>(m, "EnergyIteration")
+      .value("Jacobi", EnergyIteration::Jacobi)
+      .value("GaussSeidel", EnergyIteration::GaussSeidel);
+}
@@ -0,0 +1,13 @@
+#include <pybind11/pybind11.h>
+
+#include <moc/exp_evaluator.hpp>
+
+namespace py = pybind11;
+
+using namespace scarabee;
+
+void init_ExpEvaluator(py::module& m) {
+  py::enum_<ExpEvaluator>(m, "ExpEvaluator")
+      .value("Rational", ExpEvaluator::Rational)
+      .value("Table", ExpEvaluator::Table);
+}
@@ -50,6 +50,15 @@ void init_FDDiffusionDriver(py::module& m) {
           &FDDiffusionDriver::flux_tolerance,
           "Maximum relative error in the flux for problem convergence.")
 
+      .def_property(
+          "wielandt_shift", &FDDiffusionDriver::wielandt_shift,
+          &FDDiffusionDriver::set_wielandt_shift,
+          "Shift added to keff for Wielandt accelerated power iterations. "
+          "The shift is applied once keff is converged to within 1.E-3, and "
+          "the shifted loss matrix is only refactored when keff + shift has "
+          "changed by more than 1.E-4 (relative). Must be >= 0. Default is 0, "
+          "which disables the acceleration.")
+
       .def("flux", &FDDiffusionDriver::flux,
            "Returns the computed flux, along with the mesh bounds. The first "
            "dimension "
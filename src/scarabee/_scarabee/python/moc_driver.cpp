@@ -16,6 +16,37 @@ namespace py = pybind11;
 using namespace scarabee;
 
 void init_MOCDriver(py::module& m) {
+  py::class_<TrackingMemory>(
+      m, "TrackingMemory",
+      "Estimate of the memory required by the tracks of a "
+      ":py:class:`MOCDriver`, as returned by "
+      ":py:meth:`MOCDriver.estimate_tracking_memory`. All sizes are in "
+      "bytes.")
+
+      .def_readonly("num_tracks", &TrackingMemory::num_tracks,
+                    "Number of tracks.")
+
+      .def_readonly("num_segments", &TrackingMemory::num_segments,
+                    "Estimated number of segments, extrapolated from a sample "
+                    "of traced tracks.")
+
+      .def_readonly("track_memory", &TrackingMemory::track_memory,
+                    "Memory used by the tracks and their boundary angular "
+                    "fluxes, in both tracking modes.")
+
+      .def_readonly("stored_memory", &TrackingMemory::stored_memory,
+                    "Memory used by the segments when they are stored with "
+                    "the current :py:attr:`MOCDriver.segment_encoding`. While "
+                    "the tracks are traced, the segments temporarily use "
+                    "several times more memory.")
+
+      .def_readonly("on_the_fly_memory", &TrackingMemory::on_the_fly_memory,
+                    "Memory used by the segment renormalization factors and "
+                    "the per-thread segment buffers with on-the-fly tracking. "
+                    "This does not include the chords cached for modular "
+                    "tracking, which only depend on the number of distinct "
+                    "tiles.");
+
   py::class_<MOCDriver, std::shared_ptr<MOCDriver>>(m, "MOCDriver")
       .def(py::init<std::shared_ptr<Cartesian2D> /*geometry*/,
                     BoundaryCondition /*xmin = BoundaryCondition::Reflective*/,
@@ -72,10 +103,55 @@ void init_MOCDriver(py::module& m) {
           "             Polar quadrature for generating segment lengths.",
           py::arg("nangles"), py::arg("d"), py::arg("polar_quad"))
 
+      .def("estimate_tracking_memory", &MOCDriver::estimate_tracking_memory,
+           "Estimates the memory required by the tracks, with the segments "
+           "either stored or traced on the fly, without generating the tracks. "
+           "Only a sample of the tracks of each angle is traced.\n\n"
+           "Parameters\n"
+           "----------\n"
+           "nangles : int\n"
+           "          Number of azimuthal angles (must be even).\n"
+           "d : float\n"
+           "    Max spacing between tracks of a given angle (in cm).\n"
+           "polar_quad : PolarQuadrature\n"
+           "             Polar quadrature for generating segment lengths.\n\n"
+           "Returns\n"
+           "-------\n"
+           "TrackingMemory\n"
+           "     Estimated memory requirements.",
+           py::arg("nangles"), py::arg("d"), py::arg("polar_quad"))
+
+      .def(
+          "estimate_tracking_memory",
+          [](const MOCDriver& md, std::uint32_t na, double d,
+             PolarQuadratureType pq) {
+            return md.estimate_tracking_memory(na, d, pq);
+          },
+          "Estimates the memory required by the tracks, with the segments "
+          "either stored or traced on the fly, without generating the tracks. "
+          "Only a sample of the tracks of each angle is traced.\n\n"
+          "Parameters\n"
+          "----------\n"
+          "nangles : int\n"
+          "          Number of azimuthal angles (must be even).\n"
+          "d : float\n"
+          "    Max spacing between tracks of a given angle (in cm).\n"
+          "polar_quad : PolarQuadrature\n"
+          "             Polar quadrature for generating segment lengths.\n\n"
+          "Returns\n"
+          "-------\n"
+          "TrackingMemory\n"
+          "     Estimated memory requirements.",
+          py::arg("nangles"), py::arg("d"), py::arg("polar_quad"))
+
       .def_property_readonly(
           "drawn", &MOCDriver::drawn,
           "True if geometry has been traced, False otherwise.")
 
+      .def_property("cmfd", &MOCDriver::cmfd, &MOCDriver::set_cmfd,
+                    "Optional :py:class:`CMFD` mesh used to accelerate keff "
+                    "calculations. Must be set before tracks are generated.")
+
       .def_property(
           "keff_tolerance", &MOCDriver::keff_tolerance,
           &MOCDriver::set_keff_tolerance,
@@ -196,6 +272,54 @@ void init_MOCDriver(py::module& m) {
 
       .def("solve", &MOCDriver::solve, "Begins iterations to solve problem.")
 
+      .def("set_initial_flux",
+           py::overload_cast<const MOCDriver&>(&MOCDriver::set_initial_flux),
+           "Starts the next solve from the scalar flux, keff, and track "
+           "boundary angular fluxes of another solved MOCDriver, instead of a "
+           "flat flux. Both drivers must have the same geometry, number of "
+           "groups, tracking, and renumber_fsrs setting. This greatly reduces "
+           "the number of "
+           "iterations when solving a state close to a previous one, such as "
+           "a boron or temperature branch.\n\n"
+           "Parameters\n"
+           "----------\n"
+           "other : MOCDriver\n"
+           "        Solved driver providing the initial solution.",
+           py::arg("other"))
+
+      .def("set_initial_flux",
+           py::overload_cast<const std::string&>(&MOCDriver::set_initial_flux),
+           "Starts the next solve from the solution of an MOCDriver saved "
+           "with :py:meth:`MOCDriver.save`, which must have the same geometry, "
+           "number of groups, and tracking.\n\n"
+           "Parameters\n"
+           "----------\n"
+           "fname : str\n"
+           "        Name of file.",
+           py::arg("fname"))
+
+      .def("set_initial_flux",
+           py::overload_cast<const xt::xtensor<double, 2>&, double>(
+               &MOCDriver::set_initial_flux),
+           "Starts the next solve from a scalar flux and keff, instead of a "
+           "flat flux. The boundary angular fluxes are taken to be isotropic, "
+           "using the flux of the flat source region at each end of the "
+           "track. Only available for isotropic problems, once the tracks "
+           "have been generated.\n\n"
+           "Parameters\n"
+           "----------\n"
+           "flux : ndarray\n"
+           "       Scalar flux, indexed by group then flat source region, "
+           "with the same region indices as :py:meth:`MOCDriver.flux`.\n"
+           "keff : float\n"
+           "       Initial estimate of keff.",
+           py::arg("flux"), py::arg("keff"))
+
+      .def_property_readonly(
+          "warm_start", &MOCDriver::warm_start,
+          "True if the next solve starts from a solution provided with "
+          ":py:meth:`MOCDriver.set_initial_flux`.")
+
       .def_property(
           "sim_mode",
           [](const MOCDriver& md) -> SimulationMode { return md.sim_mode(); },
@@ -203,6 +327,175 @@ void init_MOCDriver(py::module& m) {
           ":py:class:`SimulationMode` describing type of simulation "
           "(fixed-source or keff).")
 
+      .def_property(
+          "exp_evaluator",
+          [](const MOCDriver& md) -> ExpEvaluator {
+            return md.exp_evaluator();
+          },
+          [](MOCDriver& md, ExpEvaluator& e) { md.exp_evaluator() = e; },
+          ":py:class:`ExpEvaluator` used for the exponentials in the sweep. "
+          "Rational uses a rational approximation, while Table uses an "
+          "interpolation table built when the tracks are generated. Default "
+          "is Rational.")
+
+      .def_property(
+          "sweep_parallelism",
+          [](const MOCDriver& md) -> SweepParallelism {
+            return md.sweep_parallelism();
+          },
+          [](MOCDriver& md, SweepParallelism& sp) {
+            md.sweep_parallelism() = sp;
+          },
+          ":py:class:`SweepParallelism` describing how the sweep is shared "
+          "among threads. Groups assigns whole energy groups to threads, "
+          "which limits the number of useful threads to the number of groups. "
+          "Tracks distributes every track of every group, with each thread "
+          "tallying into its own copy of the scalar flux. Outgoing angular "
+          "fluxes are then passed to the connected tracks at the end of the "
+          "sweep. Problems with anisotropic scattering always sweep the "
+          "groups one after the other, sharing the tracks of each group "
+          "among threads. Default is Groups.")
+
+      .def_property(
+          "group_block_size", &MOCDriver::group_block_size,
+          &MOCDriver::set_group_block_size,
+          "Number of energy groups treated together for each pass over a "
+          "track in the isotropic sweep. With a block size larger than 1, the "
+          "segment data is read once for all groups of a block, which reduces "
+          "memory traffic for problems with many groups. This also allows "
+          "several independent fixed-source problems, stored as uncoupled "
+          "groups, to be swept in a single pass over the tracks. With Groups "
+          "parallelism, each block is swept by a single thread. Must be in "
+          "the interval [1, 16]. Default is 1.")
+
+      .def_property(
+          "energy_iteration",
+          [](const MOCDriver& md) -> EnergyIteration {
+            return md.energy_iteration();
+          },
+          [](MOCDriver& md, EnergyIteration& ei) {
+            md.energy_iteration() = ei;
+          },
+          ":py:class:`EnergyIteration` used to update the groups in each "
+          "outer iteration of an isotropic problem. With Jacobi, all groups "
+          "are swept with a source built from the previous iterate. With "
+          "GaussSeidel, groups are swept one at a time from fast to thermal, "
+          "using the updated flux of the faster groups for the scattering "
+          "source, and the groups receiving upscatter are swept "
+          "upscatter_iterations times. Each group is then distributed over "
+          "the threads by tracks, and group_block_size is not used. Default "
+          "is Jacobi.")
+
+      .def_property(
+          "upscatter_iterations", &MOCDriver::upscatter_iterations,
+          &MOCDriver::set_upscatter_iterations,
+          "Number of passes over the groups receiving upscatter, in each "
+          "outer iteration with the GaussSeidel energy iteration. Must be at "
+          "least 1. Default is 1.")
+
+      .def_property(
+          "transport_solver",
+          [](const MOCDriver& md) -> TransportSolver {
+            return md.transport_solver();
+          },
+          [](MOCDriver& md, TransportSolver& ts) {
+            md.transport_solver() = ts;
+          },
+          ":py:class:`TransportSolver` used to converge the scattering "
+          "source of isotropic problems. SourceIteration repeats sweeps until "
+          "convergence. GMRES solves for the scalar flux and the track "
+          "angular fluxes with a matrix-free Krylov method, where each "
+          "operator application is one sweep. Fixed source problems are then "
+          "solved by a single linear solve, while keff problems use power "
+          "iteration on the fission source around the linear solves. GMRES "
+          "cannot be used with CMFD acceleration, nor in builds with "
+          "MOC_MIXED_PRECISION. Default is SourceIteration.")
+
+      .def_property("krylov_restart", &MOCDriver::krylov_restart,
+                    &MOCDriver::set_krylov_restart,
+                    "Number of GMRES iterations before a restart. Must be at "
+                    "least 1. The Krylov basis stores krylov_restart + 1 "
+                    "vectors of NG * NFSR scalar fluxes and all boundary "
+                    "angular fluxes, as doubles. Default is 30.")
+
+      .def_property("chebyshev_acceleration",
+                    &MOCDriver::chebyshev_acceleration,
+                    &MOCDriver::set_chebyshev_acceleration,
+                    "If True, the power iterations of a keff calculation are "
+                    "accelerated with Chebyshev extrapolation of the scalar "
+                    "flux and of the boundary angular fluxes. This keeps an "
+                    "extra copy of the boundary angular fluxes. It is ignored "
+                    "when a CMFD mesh is used. Default is False.")
+
+      .def_property_readonly(
+          "thread_busy_time", &MOCDriver::thread_busy_time,
+          "Time in seconds spent by each thread sweeping tracks during the "
+          "last solve. Large differences between the threads indicate a load "
+          "imbalance.")
+
+      .def_property(
+          "renumber_fsrs", &MOCDriver::renumber_fsrs,
+          &MOCDriver::set_renumber_fsrs,
+          "If True, the flat source regions are internally renumbered in the "
+          "order in which they are crossed by the tracks. This improves the "
+          "memory locality of the sweep. All methods taking or returning a "
+          "region index still use the original numbering. Only takes effect "
+          "when the tracks are generated. Default is False.")
+
+      .def_property(
+          "use_tracking_cache", &MOCDriver::use_tracking_cache,
+          &MOCDriver::set_use_tracking_cache,
+          "If True, the tracks are stored in a :py:class:`TrackingCache` when "
+          "they are generated, and tracks for an identical geometry, number of "
+          "azimuthal angles and track spacing are reused instead of being "
+          "traced again. Not used when a CMFD mesh is attached. Default is "
+          "False.")
+
+      .def_property(
+          "modular_tracking", &MOCDriver::modular_tracking,
+          &MOCDriver::set_modular_tracking,
+          "If True and all tiles of the geometry have the same size, the "
+          "azimuthal angles and track spacings are chosen for a single tile "
+          "and repeated over the lattice. Tracks then cross all tiles at the "
+          "same local positions, and the segments through each type of tile "
+          "are only traced once per angle, which speeds up the tracing. With "
+          "stored segments, the segment memory is not reduced, as the "
+          "segments are still stored for every track. Only with "
+          "on_the_fly_tracking are the segments stored once per type of tile, "
+          "and the segments of each track assembled from those of the tiles "
+          "it crosses. Only takes effect when the tracks are generated. "
+          "Default is False.")
+
+      .def_property(
+          "on_the_fly_tracking", &MOCDriver::on_the_fly_tracking,
+          &MOCDriver::set_on_the_fly_tracking,
+          "If True, the segments are not stored, and each track is traced "
+          "again once per sweep, then swept for all groups. This greatly "
+          "reduces the memory used by the tracks, but every outer iteration "
+          "pays for a pass of ray tracing over the geometry, on top of the "
+          "sweep itself. With modular tracking, the segments through each "
+          "type of tile are stored, and the tracks are assembled from them "
+          "without any geometry query, which is much cheaper. Requires track "
+          "parallelism, or group parallelism with a group_block_size holding "
+          "all groups, and cannot be used with Gauss-Seidel energy iterations, "
+          "CMFD, or multi-group anisotropic problems. Flat source regions are "
+          "not renumbered. Must be set before the tracks are generated. See "
+          ":py:meth:`estimate_tracking_memory`. Default is False.")
+
+      .def_property(
+          "segment_encoding", &MOCDriver::segment_encoding,
+          &MOCDriver::set_segment_encoding,
+          ":py:class:`SegmentEncoding` used to store the segment lengths. The "
+          "quantized encodings store each length as the shortest segment in "
+          "its flat source region plus a 16 or 32 bit multiple of a step, "
+          "which divides the range of the segment lengths in the flat source "
+          "region. This reduces the memory of the segments by a half or a "
+          "third. "
+          "The lengths are renormalized after quantization, so that the "
+          "volumes of the flat source regions are preserved. Not used with "
+          "on-the-fly tracking. Must be set before the tracks are generated. "
+          "Default is Double.")
+
       .def_property(
           "x_min_bc",
           [](const MOCDriver& md) -> BoundaryCondition {
@@ -272,6 +565,9 @@ void init_MOCDriver(py::module& m) {
                              "True if solve has been run sucessfully (reset to "
                              "false on generate_tracks).")
 
+      .def_property_readonly("iterations", &MOCDriver::iterations,
+                             "Number of outer iterations of the last solve.")
+
       .def("get_all_fsr_in_cell", &MOCDriver::get_all_fsr_in_cell,
            "Obtains the index of all Flat Source Regions contained in the Cell "
            "located at position r.\n\n"
@@ -40,6 +40,9 @@ void init_NEMDiffusionDriver(py::module& m) {
           "keff", &NEMDiffusionDriver::keff,
           "Value of keff. This is 1 by default is solved is False.")
 
+      .def_property_readonly("iterations", &NEMDiffusionDriver::iterations,
+                             "Number of outer iterations of the last solve.")
+
       .def_property("keff_tolerance", &NEMDiffusionDriver::keff_tolerance,
                     &NEMDiffusionDriver::set_keff_tolerance,
                     "Maximum relative error in keff for problem convergence.")
@@ -49,6 +52,13 @@ void init_NEMDiffusionDriver(py::module& m) {
           &NEMDiffusionDriver::set_flux_tolerance,
           "Maximum relative error in the flux for problem convergence.")
 
+      .def_property(
+          "chebyshev_acceleration", &NEMDiffusionDriver::chebyshev_acceleration,
+          &NEMDiffusionDriver::set_chebyshev_acceleration,
+          "If True, the power iterations are accelerated with Chebyshev "
+          "extrapolation of the flux moments and partial currents of the "
+          "nodes. Default is False.")
+
       .def("flux",
            py::overload_cast<double /*x*/, double /*y*/, double /*z*/,
                              std::size_t /*g*/>(&NEMDiffusionDriver::flux,
@@ -55,6 +55,11 @@ void init_PWRAssembly(py::module& m) {
       "dancoff_polar_quadrature: PolarQuadrature\n"
       "    The polar quadrature used when calculating Dancoff factors.\n"
       "    Default is YamamotoTabuchi6.\n"
+      "dancoff_modular_tracking : bool\n"
+      "    If True, the tracks of the Dancoff lattice calculation are laid\n"
+      "    down with MOCDriver.modular_tracking. This speeds up the tracing,\n"
+      "    but snaps the angles and track spacing to the pin pitch, which\n"
+      "    slightly changes the Dancoff corrections. Default is False.\n"
       "dancoff_isolation_factor : float\n"
       "    The factor used to multiply the pitch when calculating the flux in "
       "an\n"
@@ -88,6 +93,15 @@ void init_PWRAssembly(py::module& m) {
       "plot_assembly : bool\n"
       "    Indicates wether the GUI plotter for the assembly geometry will be\n"
       "    activated before performing the calcualtion.\n"
+      "use_cmfd : bool\n"
+      "    If True, the assembly MOC calculation is accelerated with a\n"
+      "    pin-wise CMFD mesh, using the few-group condensation scheme.\n"
+      "    Default value is False.\n"
+      "warm_start_moc : bool\n"
+      "    If True, the assembly MOC calculation starts from the flux of the\n"
+      "    pin cell calculations, condensed to the macrogroup structure,\n"
+      "    instead of a flat flux. Only used for isotropic scattering.\n"
+      "    Default value is False.\n"
       "fuel_dancoff_corrections : list of float\n"
       "    List of the dancoff corrections for the fuel in each pin.\n"
       "clad_dancoff_corrections : list of float\n"
@@ -192,6 +206,10 @@ void init_PWRAssembly(py::module& m) {
                     &PWRAssembly::dancoff_polar_quadrature,
                     &PWRAssembly::set_dancoff_polar_quadrature)
 
+      .def_property("dancoff_modular_tracking",
+                    &PWRAssembly::dancoff_modular_tracking,
+                    &PWRAssembly::set_dancoff_modular_tracking)
+
       .def_property("keff_tolerance", &PWRAssembly::keff_tolerance,
                     &PWRAssembly::set_keff_tolerance)
 
@@ -204,6 +222,12 @@ void init_PWRAssembly(py::module& m) {
       .def_property("plot_assembly", &PWRAssembly::plot_assembly,
                     &PWRAssembly::set_plot_assembly)
 
+      .def_property("use_cmfd", &PWRAssembly::use_cmfd,
+                    &PWRAssembly::set_use_cmfd)
+
+      .def_property("warm_start_moc", &PWRAssembly::warm_start_moc,
+                    &PWRAssembly::set_warm_start_moc)
+
       .def_property_readonly("fuel_dancoff_corrections",
                              &PWRAssembly::fuel_dancoff_corrections)
 
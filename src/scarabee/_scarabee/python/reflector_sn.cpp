@@ -38,6 +38,9 @@ void init_ReflectorSN(py::module& m) {
                              "Value of keff estimated by solver (1 by default "
                              "if no solution has been obtained).")
 
+      .def_property_readonly("iterations", &ReflectorSN::iterations,
+                             "Number of outer iterations of the last solve.")
+
       .def_property_readonly("ngroups", &ReflectorSN::ngroups,
                              "Number of energy groups.")
 
@@ -67,6 +70,12 @@ void init_ReflectorSN(py::module& m) {
           &ReflectorSN::set_flux_tolerance,
           "Maximum relative absolute difference in flux for convergence")
 
+      .def_property(
+          "chebyshev_acceleration", &ReflectorSN::chebyshev_acceleration,
+          &ReflectorSN::set_chebyshev_acceleration,
+          "If True, the power iterations are accelerated with Chebyshev "
+          "extrapolation of the scalar flux. Default is False.")
+
       .def("flux", &ReflectorSN::flux,
            "Returns the scalar flux in group g in mesh region i.\n\n"
            "Parameters\n"
@@ -26,6 +26,12 @@ extern void init_Direction(py::module&);
 extern void init_PolarQuadrature(py::module&);
 extern void init_BoundaryCondition(py::module&);
 extern void init_SimulationMode(py::module&);
+extern void init_ExpEvaluator(py::module&);
+extern void init_SweepParallelism(py::module&);
+extern void init_EnergyIteration(py::module&);
+extern void init_TransportSolver(py::module&);
+extern void init_SegmentEncoding(py::module&);
+extern void init_TrackingCache(py::module&);
 extern void init_Track(py::module&);
 extern void init_Cell(py::module&);
 extern void init_EmptyCell(py::module&);
@@ -33,6 +39,7 @@ extern void init_PinCellType(py::module&);
 extern void init_SimplePinCell(py::module&);
 extern void init_PinCell(py::module&);
 extern void init_Cartesian2D(py::module&);
+extern void init_CMFD(py::module&);
 extern void init_MOCDriver(py::module&);
 extern void init_CriticalitySpectrum(py::module&);
 extern void init_DiffusionData(py::module&);
@@ -68,6 +75,12 @@ PYBIND11_MODULE(_scarabee, m) {
   init_PolarQuadrature(m);
   init_BoundaryCondition(m);
   init_SimulationMode(m);
+  init_ExpEvaluator(m);
+  init_SweepParallelism(m);
+  init_EnergyIteration(m);
+  init_TransportSolver(m);
+  init_SegmentEncoding(m);
+  init_TrackingCache(m);
   init_Track(m);
   init_Cell(m);
   init_EmptyCell(m);
@@ -75,6 +88,7 @@ PYBIND11_MODULE(_scarabee, m) {
   init_SimplePinCell(m);
   init_PinCell(m);
   init_Cartesian2D(m);
+  init_CMFD(m);
   init_MOCDriver(m);
   init_CriticalitySpectrum(m);
   init_DiffusionData(m);
@@ -88,6 +102,13 @@ PYBIND11_MODULE(_scarabee, m) {
   init_ReflectorSN(m);
   init_WaterFuncs(m);
 
+  // Storage type of the MOC sweeps, set with SCARABEE_MIXED_PRECISION
+#ifdef SCARABEE_MIXED_PRECISION
+  m.attr("MOC_MIXED_PRECISION") = true;
+#else
+  m.attr("MOC_MIXED_PRECISION") = false;
+#endif
+
   m.attr("__author__") = "Hunter Belanger";
   m.attr("__copyright__") = "Copyright 2024, Hunter Belanger";
   m.attr("__license__") = "GPL-3.0-or-later";
@@ -0,0 +1,14 @@
+#include <pybind11/pybind11.h>
+
+#include <moc/segment_encoding.hpp>
+
+namespace py = pybind11;
+
+using namespace scarabee;
+
+void init_SegmentEncoding(py::module& m) {
+  py::enum_<SegmentEncoding>(m, "SegmentEncoding")
+      .value("Double", SegmentEncoding::Double)
+      .value("Quantized32", SegmentEncoding::Quantized32)
+      .value("Quantized16", SegmentEncoding::Quantized16);
+}
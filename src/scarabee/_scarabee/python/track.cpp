@@ -13,6 +13,6 @@ void init_Track(py::module& m) {
       .def("phi", &Track::phi)
       .def("entry_pos", &Track::entry_pos)
       .def("exit_pos", &Track::exit_pos)
-      .def("entry_flux", py::overload_cast<>(&Track::entry_flux, py::const_))
-      .def("exit_flux", py::overload_cast<>(&Track::exit_flux, py::const_));
+      .def("entry_flux_offset", &Track::entry_flux_offset)
+      .def("exit_flux_offset", &Track::exit_flux_offset);
 }
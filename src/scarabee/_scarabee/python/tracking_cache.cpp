@@ -0,0 +1,41 @@
+#include <pybind11/pybind11.h>
+
+#include <moc/tracking_cache.hpp>
+
+namespace py = pybind11;
+
+using namespace scarabee;
+
+void init_TrackingCache(py::module& m) {
+  py::class_<TrackingCache>(
+      m, "TrackingCache",
+      "Process wide cache of the tracks generated by :py:class:`MOCDriver` "
+      "instances which have use_tracking_cache enabled. Tracks are reused "
+      "for any geometry with the same layout, regardless of the materials. "
+      "Once the memory held by the cache exceeds :py:meth:`max_memory`, the "
+      "least recently used tracks are removed.")
+
+      .def_static("clear", &TrackingCache::clear,
+                  "Removes all tracks from the cache.")
+
+      .def_static("size", &TrackingCache::size,
+                  "Returns the number of track laydowns in the cache.")
+
+      .def_static("memory", &TrackingCache::memory,
+                  "Returns the approximate number of bytes held by the "
+                  "cache.")
+
+      .def_static("max_memory", &TrackingCache::max_memory,
+                  "Returns the maximum number of bytes held by the cache. "
+                  "Default is 512 MiB.")
+
+      .def_static("set_max_memory", &TrackingCache::set_max_memory,
+                  "Sets the maximum number of bytes held by the cache. Tracks "
+                  "are removed from the cache until it fits. A value of 0 "
+                  "disables the cache.\n\n"
+                  "Parameters\n"
+                  "----------\n"
+                  "max_memory : int\n"
+                  "    Maximum number of bytes.",
+                  py::arg("max_memory"));
+}
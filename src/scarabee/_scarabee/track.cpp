@@ -8,14 +8,16 @@ Track::Track(const Vector& entry, const Vector& exit, const Direction& dir,
              double phi, double wgt, double width,
              const std::vector<Segment>& segments,
              std::size_t forward_phi_index, std::size_t backward_phi_index)
-    : entry_flux_(),
-      exit_flux_(),
-      segments_(segments),
+    : segments_(segments),
+      segment_offset_(0),
+      num_segments_(segments.size()),
       entry_(entry),
       exit_(exit),
       dir_(dir),
-      entry_track_flux_(nullptr),
-      exit_track_flux_(nullptr),
+      entry_flux_offset_(0),
+      exit_flux_offset_(0),
+      entry_track_flux_offset_(0),
+      exit_track_flux_offset_(0),
       wgt_(wgt),
       width_(width),
       phi_(phi),
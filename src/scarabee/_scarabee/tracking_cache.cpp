@@ -0,0 +1,93 @@
+#include <moc/tracking_cache.hpp>
+
+#include <algorithm>
+
+namespace scarabee {
+
+std::size_t TrackLaydown::memory() const {
+  std::size_t mem = seg_lengths.size() * sizeof(MOCReal) +
+                    seg_codes16.size() * sizeof(std::uint16_t) +
+                    seg_codes32.size() * sizeof(std::uint32_t) +
+                    seg_min.size() * sizeof(double) +
+                    seg_scale.size() * sizeof(double) +
+                    seg_fsrs.size() * sizeof(std::uint32_t);
+  for (const auto& tracks_a : tracks) {
+    mem += tracks_a.size() * sizeof(Track);
+    for (const auto& t : tracks_a) mem += t.size() * sizeof(Segment);
+  }
+  return mem;
+}
+
+std::map<TrackingKey, TrackingCache::Entry> TrackingCache::cache_;
+std::size_t TrackingCache::memory_{0};
+std::size_t TrackingCache::max_memory_{512 * 1024 * 1024};
+std::uint64_t TrackingCache::use_counter_{0};
+std::mutex TrackingCache::mutex_;
+
+std::shared_ptr<const TrackLaydown> TrackingCache::get(
+    const TrackingKey& key) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = cache_.find(key);
+  if (it == cache_.end()) return nullptr;
+  it->second.last_use = ++use_counter_;
+  return it->second.laydown;
+}
+
+void TrackingCache::insert(const TrackingKey& key,
+                           std::shared_ptr<const TrackLaydown> laydown) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto it = cache_.find(key);
+  if (it != cache_.end()) {
+    memory_ -= it->second.memory;
+    cache_.erase(it);
+  }
+
+  const std::size_t mem = laydown->memory();
+  if (mem > max_memory_) return;
+
+  evict(max_memory_ - mem);
+  cache_.emplace(key, Entry{laydown, mem, ++use_counter_});
+  memory_ += mem;
+}
+
+void TrackingCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  cache_.clear();
+  memory_ = 0;
+}
+
+std::size_t TrackingCache::size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return cache_.size();
+}
+
+std::size_t TrackingCache::memory() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return memory_;
+}
+
+std::size_t TrackingCache::max_memory() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return max_memory_;
+}
+
+void TrackingCache::set_max_memory(std::size_t max_memory) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  max_memory_ = max_memory;
+  evict(max_memory_);
+}
+
+void TrackingCache::evict(std::size_t max_memory) {
+  // Only called with the mutex held
+  while (memory_ > max_memory && cache_.empty() == false) {
+    auto oldest = std::min_element(
+        cache_.begin(), cache_.end(), [](const auto& a, const auto& b) {
+          return a.second.last_use < b.second.last_use;
+        });
+    memory_ -= oldest->second.memory;
+    cache_.erase(oldest);
+  }
+}
+
+}  // namespace scarabee
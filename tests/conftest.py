@@ -0,0 +1,99 @@
+import numpy as np
+import pytest
+
+from scarabee import *
+
+# Pin lattice shared by the MOC tests: a 2x2 lattice of UO2 pins in water, with
+# two or four energy groups.
+
+PITCH = 1.26
+
+
+def uo2_xs(ngroups=2):
+    if ngroups == 2:
+        Et = np.array([2.53e-01, 8.03e-01])
+        Ea = np.array([1.03e-02, 1.03e-01])
+        Ef = np.array([3.11e-03, 6.43e-02])
+        nu = np.array([2.52, 2.43])
+        chi = np.array([1.0, 0.0])
+        Es = np.array([[2.26e-01, 1.68e-02], [0.0, 7.00e-01]])
+    else:
+        Et = np.array([0.2, 0.4, 0.6, 0.9])
+        Ea = np.array([0.01, 0.02, 0.05, 0.1])
+        Ef = np.array([0.002, 0.004, 0.02, 0.05])
+        nu = np.array([2.45, 2.45, 2.45, 2.45])
+        chi = np.array([0.8, 0.2, 0.0, 0.0])
+        Es = np.array(
+            [
+                [0.15, 0.04, 0.0, 0.0],
+                [0.0, 0.33, 0.05, 0.0],
+                [0.0, 0.0, 0.50, 0.05],
+                [0.0, 0.0, 0.0, 0.80],
+            ]
+        )
+    return CrossSection(Et, Ea, Es, Ef, nu * Ef, chi, "UO2")
+
+
+def water_xs(ngroups=2):
+    if ngroups == 2:
+        Et = np.array([5.72e-01, 2.03e00])
+        Ea = np.array([7.36e-04, 2.60e-02])
+        Es = np.array([[5.41e-01, 3.04e-02], [0.0, 2.00e00]])
+    else:
+        Et = np.array([0.25, 0.6, 1.2, 2.0])
+        Ea = np.array([0.0005, 0.001, 0.01, 0.03])
+        Es = np.array(
+            [
+                [0.17, 0.0795, 0.0, 0.0],
+                [0.0, 0.52, 0.079, 0.0],
+                [0.0, 0.0, 1.10, 0.09],
+                [0.0, 0.0, 0.0, 1.97],
+            ]
+        )
+    return CrossSection(Et, Ea, Es, "Water")
+
+
+@pytest.fixture(scope="session")
+def make_driver():
+    # Returns a function building the lattice driver. The fuel fills every ring
+    # of the pin, and the keyword options are MOCDriver properties, which are
+    # set before the tracks are generated.
+    def make(
+        radii=(0.54,),
+        ngroups=2,
+        spacing=0.1,
+        tolerance=1.0e-6,
+        anisotropic=False,
+        **options,
+    ):
+        mats = [uo2_xs(ngroups)] * len(radii) + [water_xs(ngroups)]
+        cell = SimplePinCell(list(radii), mats, PITCH, PITCH)
+        geom = Cartesian2D([PITCH] * 2, [PITCH] * 2)
+        geom.set_tiles([cell] * 4)
+
+        moc = MOCDriver(geom, anisotropic=anisotropic)
+        for name, value in options.items():
+            setattr(moc, name, value)
+        moc.generate_tracks(16, spacing, YamamotoTabuchi6())
+        moc.keff_tolerance = tolerance
+        moc.flux_tolerance = tolerance
+        return moc
+
+    return make
+
+
+@pytest.fixture(scope="session")
+def flux_array():
+    # Returns a function giving the scalar flux of a driver, indexed by group
+    # and FSR
+    def flux(moc):
+        return np.array(
+            [[moc.flux(i, g) for i in range(moc.nfsr)] for g in range(moc.ngroups)]
+        )
+
+    return flux
+
+
+@pytest.fixture(params=[SweepParallelism.Groups, SweepParallelism.Tracks])
+def parallelism(request):
+    return request.param
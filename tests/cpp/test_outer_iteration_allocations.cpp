@@ -0,0 +1,308 @@
+// Checks that the outer iterations of MOCDriver, ReflectorSN, and
+// NEMDiffusionDriver do not allocate. The same problem is solved with a loose
+// and a tight tolerance, and both solves must make the same number of heap
+// allocations, even though the second one takes more outer iterations. Any
+// allocation inside the outer loop, the sweeps, the CMFD acceleration, or the
+// GMRES solves would make the counts differ.
+//
+// All allocations go through malloc, including those of operator new and of
+// the aligned allocators of xtensor and Eigen, so malloc is replaced by a
+// counting version which forwards to glibc.
+
+#include <data/cross_section.hpp>
+#include <data/diffusion_cross_section.hpp>
+#include <diffusion/diffusion_geometry.hpp>
+#include <diffusion/nem_diffusion_driver.hpp>
+#include <moc/cartesian_2d.hpp>
+#include <moc/cmfd.hpp>
+#include <moc/moc_driver.hpp>
+#include <moc/simple_pin_cell.hpp>
+#include <moc/quadrature/yamamoto_tabuchi.hpp>
+#include <reflector_sn.hpp>
+#include <utils/logging.hpp>
+
+#include <pybind11/embed.h>
+
+#ifdef SCARABEE_USE_OMP
+#include <omp.h>
+#endif
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+std::atomic<bool> counting{false};
+std::atomic<std::size_t> allocations{0};
+
+void count_allocation() {
+  if (counting.load(std::memory_order_relaxed)) allocations++;
+}
+}  // namespace
+
+extern "C" {
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t n, std::size_t size);
+void* __libc_realloc(void* ptr, std::size_t size);
+void* __libc_memalign(std::size_t alignment, std::size_t size);
+void __libc_free(void* ptr);
+
+void* malloc(std::size_t size) noexcept {
+  count_allocation();
+  return __libc_malloc(size);
+}
+
+void* calloc(std::size_t n, std::size_t size) noexcept {
+  count_allocation();
+  return __libc_calloc(n, size);
+}
+
+void* realloc(void* ptr, std::size_t size) noexcept {
+  count_allocation();
+  return __libc_realloc(ptr, size);
+}
+
+void* aligned_alloc(std::size_t alignment, std::size_t size) noexcept {
+  count_allocation();
+  return __libc_memalign(alignment, size);
+}
+
+void* memalign(std::size_t alignment, std::size_t size) noexcept {
+  count_allocation();
+  return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** ptr, std::size_t alignment,
+                   std::size_t size) noexcept {
+  count_allocation();
+  *ptr = __libc_memalign(alignment, size);
+  return *ptr ? 0 : ENOMEM;
+}
+
+void free(void* ptr) noexcept { __libc_free(ptr); }
+}
+
+using namespace scarabee;
+
+namespace {
+
+struct Case {
+  std::string name;
+  // Builds the problem with the given tolerance, and returns a function which
+  // solves it and gives the number of outer iterations
+  std::function<std::function<std::size_t()>(double)> prepare;
+};
+
+std::shared_ptr<CrossSection> fuel_xs(bool anisotropic) {
+  const xt::xtensor<double, 1> Et{2.53e-01, 8.03e-01};
+  const xt::xtensor<double, 1> Ea{1.03e-02, 1.03e-01};
+  const xt::xtensor<double, 1> Ef{3.11e-03, 6.43e-02};
+  const xt::xtensor<double, 1> vEf{7.84e-03, 1.56e-01};
+  const xt::xtensor<double, 1> chi{1., 0.};
+  if (anisotropic) {
+    const xt::xtensor<double, 3> Es{{{2.26e-01, 1.68e-02}, {0., 7.00e-01}},
+                                    {{3.50e-02, 2.00e-03}, {0., 9.00e-02}}};
+    return std::make_shared<CrossSection>(Et, xt::zeros<double>({2}), Ea, Es,
+                                          Ef, vEf, chi, "Fuel");
+  }
+  const xt::xtensor<double, 2> Es{{2.26e-01, 1.68e-02}, {0., 7.00e-01}};
+  return std::make_shared<CrossSection>(Et, Ea, Es, Ef, vEf, chi, "Fuel");
+}
+
+std::shared_ptr<CrossSection> water_xs(bool anisotropic) {
+  const xt::xtensor<double, 1> Et{5.72e-01, 2.03e+00};
+  const xt::xtensor<double, 1> Ea{7.36e-04, 2.60e-02};
+  if (anisotropic) {
+    const xt::xtensor<double, 3> Es{{{5.41e-01, 3.04e-02}, {0., 2.00e+00}},
+                                    {{3.20e-01, 1.10e-02}, {0., 6.00e-01}}};
+    return std::make_shared<CrossSection>(Et, xt::zeros<double>({2}), Ea, Es,
+                                          "Water");
+  }
+  const xt::xtensor<double, 2> Es{{5.41e-01, 3.04e-02}, {0., 2.00e+00}};
+  return std::make_shared<CrossSection>(Et, Ea, Es, "Water");
+}
+
+// Pin lattice solved by MOC, with CMFD acceleration unless removed by setup
+Case moc_case(const std::string& name,
+              std::function<void(MOCDriver&)> setup,
+              bool anisotropic = false) {
+  return {name, [setup, anisotropic](double tol) {
+            const double pitch = 1.26;
+            auto cell = std::make_shared<SimplePinCell>(
+                std::vector<double>{0.54},
+                std::vector<std::shared_ptr<CrossSection>>{
+                    fuel_xs(anisotropic), water_xs(anisotropic)},
+                pitch, pitch);
+            auto geom = std::make_shared<Cartesian2D>(
+                std::vector<double>{pitch, pitch},
+                std::vector<double>{pitch, pitch});
+            geom->set_tiles({cell, cell, cell, cell});
+
+            auto moc = std::make_shared<MOCDriver>(
+                geom, BoundaryCondition::Reflective,
+                BoundaryCondition::Reflective, BoundaryCondition::Reflective,
+                BoundaryCondition::Reflective, anisotropic);
+            moc->set_cmfd(std::make_shared<CMFD>(
+                std::vector<double>{pitch, pitch},
+                std::vector<double>{pitch, pitch},
+                std::vector<std::pair<std::size_t, std::size_t>>{{0, 0},
+                                                                 {1, 1}}));
+            moc->generate_tracks(8, 0.1, YamamotoTabuchi<6>());
+            setup(*moc);
+            moc->set_keff_tolerance(tol);
+            moc->set_flux_tolerance(tol);
+
+            return std::function<std::size_t()>([moc] {
+              moc->solve();
+              return moc->iterations();
+            });
+          }};
+}
+
+// Slab of fuel and water reflector, with a vacuum boundary on the reflector
+Case reflector_case(const std::string& name, bool anisotropic) {
+  return {name, [anisotropic](double tol) {
+            std::vector<std::shared_ptr<CrossSection>> xs;
+            for (std::size_t i = 0; i < 10; i++)
+              xs.push_back(fuel_xs(anisotropic));
+            for (std::size_t i = 0; i < 10; i++)
+              xs.push_back(water_xs(anisotropic));
+            auto sn = std::make_shared<ReflectorSN>(
+                xs, xt::xtensor<double, 1>(xt::ones<double>({20}) * 2.),
+                anisotropic);
+            sn->set_keff_tolerance(tol);
+            sn->set_flux_tolerance(tol);
+
+            return std::function<std::size_t()>([sn] {
+              sn->solve();
+              return sn->iterations();
+            });
+          }};
+}
+
+// Quarter core of fuel nodes, with vacuum boundaries on the outer faces
+Case nem_case(const std::string& name) {
+  return {name, [](double tol) {
+            auto fuel = std::make_shared<DiffusionCrossSection>(
+                xt::xtensor<double, 1>{1.43, 0.37},
+                xt::xtensor<double, 1>{1.03e-02, 1.03e-01},
+                xt::xtensor<double, 2>{{0., 1.68e-02}, {0., 0.}},
+                xt::xtensor<double, 1>{3.11e-03, 6.43e-02},
+                xt::xtensor<double, 1>{7.84e-03, 1.56e-01},
+                xt::xtensor<double, 1>{1., 0.}, "Fuel");
+            const std::vector<DiffusionGeometry::TileFill> tiles(8, fuel);
+            auto geom = std::make_shared<DiffusionGeometry>(
+                tiles, std::vector<double>{20., 20.},
+                std::vector<std::size_t>{1, 1},
+                std::vector<double>{20., 20.}, std::vector<std::size_t>{1, 1},
+                std::vector<double>{50., 50.}, std::vector<std::size_t>{1, 1},
+                1., 0., 0., 1., 1., 0.);
+            auto nem = std::make_shared<NEMDiffusionDriver>(geom);
+            nem->set_keff_tolerance(tol);
+            nem->set_flux_tolerance(tol);
+
+            return std::function<std::size_t()>([nem] {
+              nem->solve();
+              return nem->iterations();
+            });
+          }};
+}
+
+// Number of allocations made by a solve, which takes place after the problem
+// has been built
+std::size_t solve_allocations(const Case& c, double tol,
+                              std::size_t& iterations) {
+  auto solve = c.prepare(tol);
+
+  allocations = 0;
+  counting = true;
+  iterations = solve();
+  counting = false;
+
+  return allocations;
+}
+
+bool check(const Case& c) {
+  // The first solve creates the thread pool, and is not counted
+  std::size_t iterations = 0;
+  solve_allocations(c, 1.E-2, iterations);
+
+  std::size_t loose_iterations = 0;
+  std::size_t tight_iterations = 0;
+  const std::size_t loose = solve_allocations(c, 1.E-3, loose_iterations);
+  const std::size_t tight = solve_allocations(c, 1.E-7, tight_iterations);
+
+  std::cout << c.name << ": " << loose_iterations << " iterations, " << loose
+            << " allocations; " << tight_iterations << " iterations, "
+            << tight << " allocations\n";
+
+  if (tight_iterations <= loose_iterations) {
+    std::cout << "  FAILED: both solves took the same number of iterations\n";
+    return false;
+  }
+
+  if (tight != loose) {
+    std::cout << "  FAILED: the outer iterations allocate\n";
+    return false;
+  }
+
+  return true;
+}
+
+}  // namespace
+
+int main() {
+  // The logging sink prints through Python, but nothing is logged here
+  pybind11::scoped_interpreter guard{};
+  set_logging_level(LogLevel::off);
+
+#ifdef SCARABEE_USE_OMP
+  // With a single thread, libgomp allocates a new team for every parallel
+  // region, so at least two threads are used
+  if (omp_get_max_threads() < 2) omp_set_num_threads(2);
+#endif
+
+  std::vector<Case> cases{
+      moc_case("Jacobi, parallel groups",
+               [](MOCDriver& moc) {
+                 moc.energy_iteration() = EnergyIteration::Jacobi;
+                 moc.sweep_parallelism() = SweepParallelism::Groups;
+               }),
+      moc_case("Jacobi, parallel tracks",
+               [](MOCDriver& moc) {
+                 moc.energy_iteration() = EnergyIteration::Jacobi;
+                 moc.sweep_parallelism() = SweepParallelism::Tracks;
+               }),
+      moc_case("Gauss-Seidel",
+               [](MOCDriver& moc) {
+                 moc.energy_iteration() = EnergyIteration::GaussSeidel;
+               }),
+      moc_case(
+          "Anisotropic",
+          [](MOCDriver& moc) {
+            moc.energy_iteration() = EnergyIteration::Jacobi;
+          },
+          true),
+      reflector_case("ReflectorSN, isotropic", false),
+      reflector_case("ReflectorSN, anisotropic", true),
+      nem_case("NEMDiffusionDriver"),
+  };
+
+  // GMRES is rejected with mixed precision sweeps
+#ifndef SCARABEE_MIXED_PRECISION
+  cases.push_back(moc_case("GMRES", [](MOCDriver& moc) {
+    moc.set_cmfd(nullptr);
+    moc.transport_solver() = TransportSolver::GMRES;
+  }));
+#endif
+
+  bool passed = true;
+  for (const auto& c : cases) passed = check(c) && passed;
+
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
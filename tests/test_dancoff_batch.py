@@ -0,0 +1,65 @@
+import numpy as np
+import pytest
+
+from scarabee import *
+
+# The fuel and clad Dancoff problems of PWRAssembly are solved together, as
+# the two uncoupled groups of a single fixed-source problem. Each group must
+# give the flux of the corresponding one-group problem.
+
+PITCH = 1.26
+RADII = [0.4095, 0.475]
+BLACK = 1.0e5
+
+# Potential cross sections of the fuel, clad and moderator
+POTENTIAL = {"Fuel": 0.4, "Clad": 0.3, "Mod": 1.4}
+
+# Material which is black in each problem
+BLACK_MATERIALS = ["Fuel", "Clad"]
+
+FLUX_TOLERANCE = 1.0e-6
+# The batched problem keeps iterating until both groups have converged, so
+# a group may be more converged than its separate problem
+MATCH_TOLERANCE = 1.0e-4
+
+
+def dancoff_xs(name, black_materials):
+    Et = np.array(
+        [BLACK if name == black else POTENTIAL[name] for black in black_materials]
+    )
+    Es = np.zeros((Et.size, Et.size))
+    return CrossSection(Et, Et, Es, name)
+
+
+def solve_dancoff(black_materials, parallelism, block_size):
+    mats = [dancoff_xs(n, black_materials) for n in ["Fuel", "Clad", "Mod"]]
+    cell = SimplePinCell(RADII, mats, PITCH, PITCH)
+    geom = Cartesian2D([PITCH] * 3, [PITCH] * 3)
+    geom.set_tiles([cell] * 9)
+
+    moc = MOCDriver(geom)
+    moc.sim_mode = SimulationMode.FixedSource
+    for i in range(moc.nfsr):
+        xs = moc.xs(i)
+        for g, black in enumerate(black_materials):
+            if xs.name != black:
+                moc.set_extern_src(i, g, xs.Et(g))
+
+    moc.generate_tracks(32, 0.05, YamamotoTabuchi6())
+    moc.sweep_parallelism = parallelism
+    moc.group_block_size = block_size
+    moc.flux_tolerance = FLUX_TOLERANCE
+    moc.solve()
+    return moc
+
+
+def test_batched_dancoff_matches_separate_problems(parallelism):
+    batched = solve_dancoff(BLACK_MATERIALS, parallelism, len(BLACK_MATERIALS))
+
+    for g, black in enumerate(BLACK_MATERIALS):
+        separate = solve_dancoff([black], parallelism, 1)
+        assert separate.nfsr == batched.nfsr
+        for i in range(batched.nfsr):
+            assert batched.flux(i, g) == pytest.approx(
+                separate.flux(i, 0), rel=MATCH_TOLERANCE
+            )
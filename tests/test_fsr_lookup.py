@@ -0,0 +1,88 @@
+import numpy as np
+import pytest
+
+from scarabee import *
+
+# The FSR lookup of the pin cells must give the same FSR as testing every FSR
+# in turn, including on the ring and sector boundaries, and for half and
+# quarter pins whose rings are centered on a cell wall.
+
+PITCH = 1.26
+HALF = 0.5 * PITCH
+RADII = [0.2, 0.4, 0.54]
+
+# Width, height, and pin center of each pin cell type
+PIN_TYPES = {
+    PinCellType.Full: (PITCH, PITCH, (0.0, 0.0)),
+    PinCellType.XN: (HALF, PITCH, (0.5 * HALF, 0.0)),
+    PinCellType.XP: (HALF, PITCH, (-0.5 * HALF, 0.0)),
+    PinCellType.YN: (PITCH, HALF, (0.0, 0.5 * HALF)),
+    PinCellType.YP: (PITCH, HALF, (0.0, -0.5 * HALF)),
+    PinCellType.I: (HALF, HALF, (-0.5 * HALF, -0.5 * HALF)),
+    PinCellType.II: (HALF, HALF, (0.5 * HALF, -0.5 * HALF)),
+    PinCellType.III: (HALF, HALF, (0.5 * HALF, 0.5 * HALF)),
+    PinCellType.IV: (HALF, HALF, (-0.5 * HALF, 0.5 * HALF)),
+}
+
+DIRECTIONS = [Direction(phi) for phi in np.linspace(0.1, 2.0 * np.pi, 7)]
+
+
+def water_xs():
+    Et = np.array([5.72e-01, 2.03e00])
+    Ea = np.array([7.36e-04, 2.60e-02])
+    Es = np.array([[5.41e-01, 3.04e-02], [0.0, 2.00e00]])
+    return CrossSection(Et, Ea, Es, "Water")
+
+
+def make_cell(cell_type, pin_type):
+    dx, dy, _ = PIN_TYPES[pin_type]
+    xs = water_xs()
+    return cell_type(RADII, [xs] * (len(RADII) + 1), dx, dy, pin_type)
+
+
+def boundary_points(pin_type):
+    # Points on every ring, at the sector boundaries and between them, and
+    # the center of the pin
+    _, _, (x0, y0) = PIN_TYPES[pin_type]
+    points = [Vector(x0, y0)]
+    for r in RADII:
+        for phi in np.linspace(0.0, 2.0 * np.pi, 32, endpoint=False):
+            points.append(Vector(x0 + r * np.cos(phi), y0 + r * np.sin(phi)))
+    # Points on the sector boundaries, between the rings
+    for r in np.linspace(0.05, 0.6, 12):
+        for phi in np.linspace(0.0, 2.0 * np.pi, 8, endpoint=False):
+            points.append(Vector(x0 + r * np.cos(phi), y0 + r * np.sin(phi)))
+    return points
+
+
+def random_points(pin_type, n=500):
+    dx, dy, _ = PIN_TYPES[pin_type]
+    rng = np.random.default_rng(42)
+    xs = rng.uniform(-0.5 * dx, 0.5 * dx, n)
+    ys = rng.uniform(-0.5 * dy, 0.5 * dy, n)
+    return [Vector(x, y) for x, y in zip(xs, ys)]
+
+
+def check_lookup(cell, points):
+    nfound = 0
+    for r in points:
+        for u in DIRECTIONS:
+            fsr = cell.get_fsr_id(r, u)
+            assert fsr == cell._search_fsr_id(r, u)
+            if fsr is not None:
+                nfound += 1
+    assert nfound > 0
+
+
+@pytest.mark.parametrize("cell_type", [PinCell, SimplePinCell])
+@pytest.mark.parametrize("pin_type", list(PIN_TYPES))
+def test_lookup_matches_linear_search(cell_type, pin_type):
+    cell = make_cell(cell_type, pin_type)
+    check_lookup(cell, random_points(pin_type))
+
+
+@pytest.mark.parametrize("cell_type", [PinCell, SimplePinCell])
+@pytest.mark.parametrize("pin_type", list(PIN_TYPES))
+def test_lookup_matches_linear_search_on_boundaries(cell_type, pin_type):
+    cell = make_cell(cell_type, pin_type)
+    check_lookup(cell, boundary_points(pin_type))
@@ -0,0 +1,33 @@
+import numpy as np
+import pytest
+
+from scarabee import *
+
+# Sweeping several groups per pass over a track only changes the order of the
+# loops, so the solution must match the one with one group per pass, up to
+# round-off. Four groups are used, so that some block sizes do not divide the
+# number of groups.
+
+
+def solve(make_driver, flux_array, parallelism, block_size):
+    moc = make_driver(
+        ngroups=4,
+        tolerance=1.0e-7,
+        sweep_parallelism=parallelism,
+        group_block_size=block_size,
+    )
+    moc.solve()
+    return moc.keff, flux_array(moc)
+
+
+@pytest.mark.parametrize("block_size", [2, 3, 4])
+def test_blocked_sweep_matches_single_group(
+    make_driver, flux_array, parallelism, block_size
+):
+    keff, flux = solve(make_driver, flux_array, parallelism, 1)
+    blocked_keff, blocked_flux = solve(
+        make_driver, flux_array, parallelism, block_size
+    )
+
+    assert blocked_keff == pytest.approx(keff, abs=1.0e-7)
+    np.testing.assert_allclose(blocked_flux, flux, rtol=1.0e-6)
@@ -0,0 +1,54 @@
+import pytest
+
+from scarabee import *
+
+# Tracks traced on the fly are swept for all groups after a single tracing,
+# and must give the same solution as the stored tracks.
+
+
+@pytest.mark.parametrize("modular", [False, True])
+@pytest.mark.parametrize(
+    "parallelism, block_size",
+    [
+        (SweepParallelism.Tracks, 1),
+        (SweepParallelism.Tracks, 2),
+        (SweepParallelism.Groups, 2),
+    ],
+)
+def test_on_the_fly_matches_stored_tracks(
+    make_driver, modular, parallelism, block_size
+):
+    stored = make_driver(on_the_fly_tracking=False, modular_tracking=modular)
+    stored.solve()
+
+    otf = make_driver(on_the_fly_tracking=True, modular_tracking=modular)
+    otf.sweep_parallelism = parallelism
+    otf.group_block_size = block_size
+    otf.solve()
+
+    assert otf.keff == pytest.approx(stored.keff, abs=1.0e-5)
+    for i in range(stored.nfsr):
+        for g in range(stored.ngroups):
+            assert otf.flux(i, g) == pytest.approx(stored.flux(i, g), rel=1.0e-4)
+
+
+def test_on_the_fly_rejects_gauss_seidel(make_driver):
+    moc = make_driver(on_the_fly_tracking=True)
+    moc.energy_iteration = EnergyIteration.GaussSeidel
+    with pytest.raises(RuntimeError):
+        moc.solve()
+
+
+def test_on_the_fly_rejects_group_parallel_blocks(make_driver):
+    moc = make_driver(on_the_fly_tracking=True)
+    moc.sweep_parallelism = SweepParallelism.Groups
+    moc.group_block_size = 1
+    with pytest.raises(RuntimeError):
+        moc.solve()
+
+
+def test_on_the_fly_rejects_multigroup_anisotropic(make_driver):
+    moc = make_driver(on_the_fly_tracking=True, anisotropic=True)
+    moc.sweep_parallelism = SweepParallelism.Tracks
+    with pytest.raises(RuntimeError):
+        moc.solve()
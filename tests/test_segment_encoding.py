@@ -0,0 +1,36 @@
+import numpy as np
+import pytest
+
+from scarabee import *
+
+# Two group UO2 pin lattice, solved with each segment encoding. The thin rings
+# of the pin give FSRs whose chords range from nearly zero to the ring
+# diameter, which the quantized encodings must keep accurate.
+
+
+def solve(make_driver, flux_array, encoding):
+    moc = make_driver(
+        radii=(0.1, 0.2, 0.54),
+        spacing=0.05,
+        tolerance=1.0e-7,
+        segment_encoding=encoding,
+    )
+    moc.solve()
+    return moc.keff, flux_array(moc)
+
+
+@pytest.fixture(scope="module")
+def reference(make_driver, flux_array):
+    return solve(make_driver, flux_array, SegmentEncoding.Double)
+
+
+@pytest.mark.parametrize(
+    "encoding", [SegmentEncoding.Quantized32, SegmentEncoding.Quantized16]
+)
+def test_quantized_encoding_matches_double(
+    make_driver, flux_array, reference, encoding
+):
+    keff, flux = solve(make_driver, flux_array, encoding)
+
+    assert keff == pytest.approx(reference[0], abs=1.0e-5)
+    np.testing.assert_allclose(flux, reference[1], rtol=1.0e-4)
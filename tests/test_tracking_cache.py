@@ -0,0 +1,81 @@
+import numpy as np
+import pytest
+
+from scarabee import *
+
+# Tracks are shared between geometries with the same layout, and the cache is
+# bounded by TrackingCache.max_memory.
+
+PITCH = 1.26
+
+
+def absorber_xs(name, Et):
+    Et = np.array([Et])
+    Es = np.zeros((1, 1))
+    return CrossSection(Et, Et, Es, name)
+
+
+def make_driver(radius=0.54, fuel_Et=0.5, d=0.1):
+    mats = [absorber_xs("Fuel", fuel_Et), absorber_xs("Mod", 1.0)]
+    cell = SimplePinCell([radius], mats, PITCH, PITCH)
+    geom = Cartesian2D([PITCH] * 2, [PITCH] * 2)
+    geom.set_tiles([cell] * 4)
+
+    moc = MOCDriver(geom)
+    moc.use_tracking_cache = True
+    moc.generate_tracks(8, d, YamamotoTabuchi6())
+    return moc
+
+
+@pytest.fixture(autouse=True)
+def empty_cache():
+    max_memory = TrackingCache.max_memory()
+    TrackingCache.clear()
+    yield
+    TrackingCache.set_max_memory(max_memory)
+    TrackingCache.clear()
+
+
+def test_same_layout_shares_tracks():
+    make_driver(fuel_Et=0.5)
+    make_driver(fuel_Et=2.0)
+    assert TrackingCache.size() == 1
+    assert TrackingCache.memory() > 0
+
+
+def test_full_key_is_compared():
+    make_driver()
+    make_driver(radius=0.4)
+    make_driver(d=0.05)
+    assert TrackingCache.size() == 3
+
+
+def laydown_memory(radius):
+    TrackingCache.clear()
+    make_driver(radius=radius)
+    mem = TrackingCache.memory()
+    TrackingCache.clear()
+    return mem
+
+
+def test_least_recently_used_is_evicted():
+    # Laydowns with a different number of segments, to tell them apart
+    small = laydown_memory(0.3)
+    large = laydown_memory(0.6)
+    assert small != large
+
+    make_driver(radius=0.3)
+    make_driver(radius=0.6)
+    make_driver(radius=0.3)
+    TrackingCache.set_max_memory(small + large - 1)
+
+    # The laydown with radius 0.3 was used last, so it must have been kept
+    assert TrackingCache.size() == 1
+    assert TrackingCache.memory() == small
+
+
+def test_zero_max_memory_disables_cache():
+    TrackingCache.set_max_memory(0)
+    make_driver()
+    assert TrackingCache.size() == 0
+    assert TrackingCache.memory() == 0
@@ -0,0 +1,44 @@
+import numpy as np
+import pytest
+
+from scarabee import *
+
+# Two group UO2 pin lattice, used to check that a solve started from a
+# converged solution needs next to no outer iterations.
+
+
+@pytest.mark.parametrize("renumber", [False, True])
+def test_warm_start_from_driver(make_driver, renumber):
+    cold = make_driver(renumber_fsrs=renumber)
+    cold.solve()
+
+    warm = make_driver(renumber_fsrs=renumber)
+    warm.set_initial_flux(cold)
+    warm.solve()
+
+    assert warm.iterations <= 2
+    assert warm.iterations < cold.iterations
+    assert warm.keff == pytest.approx(cold.keff, abs=1.0e-5)
+
+
+def test_warm_start_from_flux_uses_original_numbering(make_driver, flux_array):
+    cold = make_driver(renumber_fsrs=False)
+    cold.solve()
+    flux = flux_array(cold)
+
+    warm = make_driver(renumber_fsrs=True)
+    warm.set_initial_flux(flux, cold.keff)
+    np.testing.assert_allclose(flux_array(warm), flux)
+
+    warm.solve()
+    assert warm.iterations < cold.iterations
+    assert warm.keff == pytest.approx(cold.keff, abs=1.0e-5)
+
+
+def test_warm_start_rejects_other_numbering(make_driver):
+    cold = make_driver(renumber_fsrs=False)
+    cold.solve()
+
+    warm = make_driver(renumber_fsrs=True)
+    with pytest.raises(RuntimeError):
+        warm.set_initial_flux(cold)